@@ -1,21 +1,176 @@
 #ifndef AVL_H
 #define AVL_H
 
+#include <stddef.h>
+#include "pool.h"
+#include "bloom.h"
+
 typedef struct AVLNode {
     int key;
     int height;
+    int size;                   /* Live nodes in this subtree (sized only) */
+    unsigned count : 30;        /* Copies of key (multiset mode), else 1 */
+    unsigned dead : 1;          /* Tombstone left by a lazy delete */
+    unsigned sized : 1;         /* size is kept up to date */
     struct AVLNode *left;
     struct AVLNode *right;
 } AVLNode;
 
-/* Core API */
+/* Largest count a multiset node can reach (30 bits); an insert past it
+ * fails */
+#define AVL_MAX_COUNT 0x3FFFFFFF
+
+/* AVL height is at most 1.44 * log2(n + 2), far below this for 32-bit n */
+#define AVL_MAX_DEPTH 64
+
+/* In-order cursor: the path from the root to the current node. Any insert
+ * or delete on the tree invalidates it. */
+typedef struct {
+    AVLNode* root;
+    AVLNode* path[AVL_MAX_DEPTH];
+    int depth;
+} AVLCursor;
+
+/* Range visitor: return nonzero to continue, 0 to stop */
+typedef int (*AVLVisitFn)(AVLNode* node, void* arg);
+
+/* One entry of a batch update */
+typedef enum {
+    AVL_BATCH_INSERT,
+    AVL_BATCH_DELETE
+} AVLBatchKind;
+
+typedef struct {
+    int key;
+    AVLBatchKind kind;
+} AVLBatchOp;
+
+/* Tree handle: owns the node storage (pool == NULL uses malloc/free) */
+typedef struct {
+    AVLNode *root;
+    NodePool *pool;
+    int tombstones;             /* Lazily deleted nodes still linked */
+    double tombstone_limit;     /* Compact past this fraction (0: eager) */
+    BloomFilter *bloom;         /* Optional negative-lookup filter */
+    int multiset;               /* Duplicates bump count instead of being dropped */
+    int sized;                  /* New nodes keep subtree sizes */
+    int nodes;                  /* Linked nodes, tombstones included */
+} AVLTree;
+
+/* Core API. Trees built by these node-level functions keep subtree sizes;
+ * a tree handle only does after avl_set_sized. */
 AVLNode* avl_insert(AVLNode* root, int key);
 AVLNode* avl_delete(AVLNode* root, int key);
 AVLNode* avl_search(AVLNode* root, int key);
+int      avl_search_batch(AVLNode* root, const int* keys, int n, AVLNode** out);
 void     avl_free(AVLNode* root);
 
+/* Bulk build from strictly ascending keys (NULL if unsorted, empty or out
+ * of memory: a failed build frees whatever it had allocated) */
+AVLNode* avl_build_sorted(const int* keys, int n);
+
+/* Bulk load from unsorted keys, sorting and building on `threads` threads
+ * (<= 0: all cores). Duplicates are dropped. */
+AVLNode* avl_bulk_load(const int* keys, int n, int threads);
+
+/* Split into keys < key and keys >= key, and the inverse (every key of
+ * left below every key of right). Both O(log n); nodes are relinked, not
+ * copied. */
+void     avl_split(AVLNode* root, int key, AVLNode** left, AVLNode** right);
+AVLNode* avl_join(AVLNode* left, AVLNode* right);
+
+/* Nearest keys in one descent (NULL if none): floor <= key, ceil >= key,
+ * predecessor < key, successor > key */
+AVLNode* avl_floor(AVLNode* root, int key);
+AVLNode* avl_ceil(AVLNode* root, int key);
+AVLNode* avl_predecessor(AVLNode* root, int key);
+AVLNode* avl_successor(AVLNode* root, int key);
+
+/* Range queries over [lo, hi]: count in O(log n) (O(log n + k) by walking
+ * the range without sizes), delete in O(log n + k) */
+int      avl_range_count(AVLNode* root, int lo, int hi);
+AVLNode* avl_delete_range(AVLNode* root, int lo, int hi);
+
+/* Cursor: each call returns the new current node, NULL once it runs off
+ * either end. seek lands on the first key >= key. */
+void     avl_cursor_init(AVLCursor* c, AVLNode* root);
+AVLNode* avl_cursor_first(AVLCursor* c);
+AVLNode* avl_cursor_last(AVLCursor* c);
+AVLNode* avl_cursor_seek(AVLCursor* c, int key);
+AVLNode* avl_cursor_next(AVLCursor* c);
+AVLNode* avl_cursor_prev(AVLCursor* c);
+
+/* Call fn on each key in [lo, hi] in order; returns the number visited */
+int      avl_visit_range(AVLNode* root, int lo, int hi, AVLVisitFn fn, void* arg);
+
+/* Order statistics, O(log n): rank = keys smaller than key, select(k) =
+ * k-th smallest from 0 (NULL if out of range), sample = select(r mod n).
+ * They need sizes: rank returns -1 and select/sample NULL otherwise. */
+int      avl_rank(AVLNode* root, int key);
+AVLNode* avl_select(AVLNode* root, int k);
+AVLNode* avl_sample(AVLNode* root, unsigned int r);
+
+/* Set operations on two trees, consumed to build the result (nodes are
+ * reused, dropped ones freed). Recursion runs on `threads` threads (<= 0:
+ * all cores). Difference is a minus b. */
+AVLNode* avl_union(AVLNode* a, AVLNode* b, int threads);
+AVLNode* avl_intersection(AVLNode* a, AVLNode* b, int threads);
+AVLNode* avl_difference(AVLNode* a, AVLNode* b, int threads);
+
+/* Apply a batch of inserts/deletes with strictly ascending keys in one
+ * recursive pass, O(m log(n/m + 1)), on `threads` threads (<= 0: all
+ * cores). An unsorted batch leaves the tree unchanged. */
+AVLNode* avl_apply_batch(AVLNode* root, const AVLBatchOp* ops, int m, int threads);
+
 /* Helpers (exposed for testing & visualization) */
 int      avl_height(AVLNode* node);
+int      avl_size(AVLNode* node);   /* O(1) if sized, else counts the subtree */
 int      avl_balance_factor(AVLNode* node);
 
+/* Tree handle operations */
+AVLTree* avl_create(void);
+AVLTree* avl_create_pooled(size_t nodes_per_slab);
+void     avl_destroy(AVLTree* tree);
+AVLNode* avl_tree_insert(AVLTree* tree, int key);
+int      avl_tree_delete(AVLTree* tree, int key);
+int      avl_tree_delete_range(AVLTree* tree, int lo, int hi);
+int      avl_tree_apply(AVLTree* tree, const AVLBatchOp* ops, int m, int threads);
+
+/* Bulk build into an empty tree, nodes taken from its storage in preorder
+ * (contiguous in a pooled tree). 1 on success; 0 if the tree is not
+ * empty, sorted input is not strictly ascending, or memory runs out, in
+ * which case the tree is left empty. */
+int      avl_tree_build_sorted(AVLTree* tree, const int* keys, int n);
+int      avl_tree_bulk_load(AVLTree* tree, const int* keys, int n, int threads);
+
+/* Optional Bloom filter in front of avl_tree_search (bits_per_key <= 0:
+ * default). Kept current by the tree-handle inserts and deletes and
+ * rebuilt from the keys once too many deletes have made it stale. */
+int      avl_tree_enable_bloom(AVLTree* tree, int bits_per_key);
+AVLNode* avl_tree_search(AVLTree* tree, int key);
+
+/* Lazy delete: avl_tree_delete marks a tombstone in O(log n) and the tree
+ * is compacted in O(n) once tombstones pass `limit` of its nodes. Search,
+ * neighbour queries, cursors, sizes, rank/select/sample and range counts
+ * all skip tombstones; only `nodes` still counts them. */
+void     avl_set_lazy_delete(AVLTree* tree, double limit);
+void     avl_tree_compact(AVLTree* tree);
+
+/* Multiset mode (switch only while the tree is empty; 0 otherwise): a
+ * repeated insert increments the node's count in place, with no
+ * allocation or rebalancing, and a delete decrements it; the last copy
+ * goes through the normal (lazy or eager) delete. An insert that would
+ * take a count past AVL_MAX_COUNT returns NULL and changes nothing.
+ * Sizes, rank and range counts still count distinct keys; batch apply and
+ * set operations treat keys as sets. */
+int      avl_set_multiset(AVLTree* tree, int enabled);
+int      avl_tree_count(AVLTree* tree, int key);
+
+/* Subtree sizes (switch only while the tree is empty; 0 otherwise). Off by
+ * default: inserts and deletes then skip the size walk along the path, and
+ * the tree keeps its node count in `nodes`. On: rank, select and sample
+ * work on tree->root and range counts take O(log n). Split, join, set
+ * operations and batches expect every tree involved in the same mode. */
+int      avl_set_sized(AVLTree* tree, int enabled);
+
 #endif
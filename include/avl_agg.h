@@ -0,0 +1,48 @@
+#ifndef AVL_AGG_H
+#define AVL_AGG_H
+
+/* ============================================================================
+ * Aggregate-Augmented AVL Tree
+ *
+ * An AVL map from int keys to long long values in which every node also
+ * caches the count, sum, minimum and maximum of the values in its subtree.
+ * The cache is refreshed by the rotations and by the insert/delete retrace,
+ * so the aggregate over any key range [lo, hi] costs O(log n).
+ * ============================================================================
+ */
+
+typedef struct AVLAggNode {
+    int key;
+    int height;                 /* Edges: leaf = 0, empty = -1 */
+    int count;                  /* Subtree aggregates */
+    long long value;
+    long long sum;
+    long long min;
+    long long max;
+    struct AVLAggNode *left;
+    struct AVLAggNode *right;
+} AVLAggNode;
+
+/* Aggregate of a key range (count == 0: sum 0, min/max meaningless) */
+typedef struct {
+    int count;
+    long long sum;
+    long long min;
+    long long max;
+} AVLAggregate;
+
+/* Core API: insert overwrites the value of an existing key, add increments
+ * it (inserting the key with `delta` if absent) */
+AVLAggNode*  avl_agg_insert(AVLAggNode* root, int key, long long value);
+AVLAggNode*  avl_agg_add(AVLAggNode* root, int key, long long delta);
+AVLAggNode*  avl_agg_delete(AVLAggNode* root, int key);
+AVLAggNode*  avl_agg_search(AVLAggNode* root, int key);
+void         avl_agg_free(AVLAggNode* root);
+
+/* Count/sum/min/max over the values with keys in [lo, hi], O(log n) */
+AVLAggregate avl_agg_range(AVLAggNode* root, int lo, int hi);
+
+/* Helpers (exposed for testing) */
+int          avl_agg_height(AVLAggNode* node);
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef BLOOM_H
+#define BLOOM_H
+
+#include <stddef.h>
+
+/* ============================================================================
+ * Blocked Bloom Filter
+ *
+ * Membership pre-check kept next to a tree. Every key sets all of its bits
+ * inside one 64-byte block, so a query costs a single cache-line probe and
+ * a miss is usually rejected before the tree is touched. There are no
+ * false negatives.
+ *
+ * Bits cannot be cleared, so deletes only count as stale entries. The
+ * owning tree rebuilds the filter from its keys once bloom_stale says the
+ * stale entries (or growth past capacity) hurt the false-positive rate.
+ * ============================================================================
+ */
+
+#define BLOOM_BLOCK_BYTES      64
+#define BLOOM_DEFAULT_BITS     10      /* Bits per key: ~1% false positives */
+
+typedef struct BloomFilter BloomFilter;
+
+/* Lifecycle (bits_per_key <= 0 selects BLOOM_DEFAULT_BITS) */
+BloomFilter* bloom_create(size_t capacity, int bits_per_key);
+void         bloom_destroy(BloomFilter *filter);
+
+/* Empty the filter and size it for `capacity` keys; 0 on allocation failure
+ * (the filter is then left as it was) */
+int          bloom_reset(BloomFilter *filter, size_t capacity);
+
+/* Maintenance */
+void         bloom_add(BloomFilter *filter, int key);
+void         bloom_remove(BloomFilter *filter, size_t count);
+
+/* Queries: 0 means definitely absent */
+int          bloom_may_contain(const BloomFilter *filter, int key);
+int          bloom_stale(const BloomFilter *filter);
+
+#endif /* BLOOM_H */
@@ -1,20 +1,131 @@
 #ifndef BST_H
 #define BST_H
 
+#include <stddef.h>
+#include <limits.h>
+#include "pool.h"
+
 typedef struct BSTNode {
     int key;
+    int size;                   /* Nodes in this subtree (sized nodes only) */
+    unsigned count : 31;        /* Copies of key (multiset mode), else 1 */
+    unsigned sized : 1;         /* size is kept up to date */
     struct BSTNode *left;
     struct BSTNode *right;
 } BSTNode;
 
-/* Core operations */
+/* Largest count a multiset node can reach (31 bits); an insert past it
+ * fails */
+#define BST_MAX_COUNT 0x7FFFFFFF
+
+/* In-order cursor: the path from the root to the current node (grown on
+ * demand, since a BST can be arbitrarily deep). Any insert or delete on the
+ * tree invalidates it. */
+typedef struct {
+    BSTNode* root;
+    BSTNode** path;
+    int depth;
+    int capacity;
+} BSTCursor;
+
+/* Range visitor: return nonzero to continue, 0 to stop */
+typedef int (*BSTVisitFn)(BSTNode* node, void* arg);
+
+/* Tree handle: owns the node storage (pool == NULL uses malloc/free) */
+typedef struct {
+    BSTNode *root;
+    NodePool *pool;
+    double rebalance_c;         /* Auto-rebalance when depth > c*log2(n) (0: off) */
+    int rebalances;             /* Rebalances run so far */
+    long long rebuilt;          /* Nodes they rebuilt in total */
+    int multiset;               /* Duplicates bump count instead of being dropped */
+    int sized;                  /* New nodes keep subtree sizes */
+    int nodes;                  /* Nodes in the tree */
+} BSTree;
+
+/* Core operations. Trees built by these node-level functions keep subtree
+ * sizes; a tree handle only does after bst_set_sized. */
 BSTNode* bst_insert(BSTNode* root, int key);
 BSTNode* bst_delete(BSTNode* root, int key);
 BSTNode* bst_search(BSTNode* root, int key);
 
+/* Nearest keys in one descent (NULL if none): floor <= key, ceil >= key,
+ * predecessor < key, successor > key */
+BSTNode* bst_floor(BSTNode* root, int key);
+BSTNode* bst_ceil(BSTNode* root, int key);
+BSTNode* bst_predecessor(BSTNode* root, int key);
+BSTNode* bst_successor(BSTNode* root, int key);
+
+/* Look up ascending keys[0..m) in one walk: out[i] is the node holding
+ * keys[i] or NULL. O(m log(n/m + 1)) on a balanced tree. Returns the
+ * number found, -1 if keys are not sorted (or out of memory). */
+int      bst_search_sorted(BSTNode* root, const int* keys, int m, BSTNode** out);
+
+/* Range queries over [lo, hi]: count in O(h) (O(h + k) by walking the
+ * range without sizes), delete in O(h + k) */
+int      bst_range_count(BSTNode* root, int lo, int hi);
+BSTNode* bst_delete_range(BSTNode* root, int lo, int hi);
+
+/* Cursor: each call returns the new current node, NULL once it runs off
+ * either end. seek lands on the first key >= key. */
+void     bst_cursor_init(BSTCursor* c, BSTNode* root);
+void     bst_cursor_release(BSTCursor* c);
+BSTNode* bst_cursor_first(BSTCursor* c);
+BSTNode* bst_cursor_last(BSTCursor* c);
+BSTNode* bst_cursor_seek(BSTCursor* c, int key);
+BSTNode* bst_cursor_next(BSTCursor* c);
+BSTNode* bst_cursor_prev(BSTCursor* c);
+
+/* Call fn on each key in [lo, hi] in order; returns the number visited */
+int      bst_visit_range(BSTNode* root, int lo, int hi, BSTVisitFn fn, void* arg);
+
+/* In-place Day-Stout-Warren rebalance to minimum height: O(n) time,
+ * O(1) extra memory. Returns the new root. */
+BSTNode* bst_rebalance(BSTNode* root);
+
 /* Utilities */
+int      bst_size(BSTNode* node);   /* O(1) if sized, else counts the subtree */
 BSTNode* bst_min(BSTNode* root);
 void     bst_inorder(BSTNode* root, int* arr, int* index);
 void     bst_free(BSTNode* root);
 
+/* Bulk build from strictly ascending keys (NULL if unsorted, empty or out
+ * of memory: a failed build frees whatever it had allocated) */
+BSTNode* bst_build_sorted(const int* keys, int n);
+
+/* Bulk load from unsorted keys, sorting and building on `threads` threads
+ * (<= 0: all cores). Duplicates are dropped. */
+BSTNode* bst_bulk_load(const int* keys, int n, int threads);
+
+/* Tree handle operations */
+BSTree*  bst_create(void);
+BSTree*  bst_create_pooled(size_t nodes_per_slab);
+void     bst_destroy(BSTree* tree);
+BSTNode* bst_tree_insert(BSTree* tree, int key);
+int      bst_tree_delete(BSTree* tree, int key);
+int      bst_tree_delete_range(BSTree* tree, int lo, int hi);
+void     bst_tree_rebalance(BSTree* tree);
+void     bst_set_auto_rebalance(BSTree* tree, double c);
+
+/* Bulk build into an empty tree, nodes taken from its storage in preorder
+ * (contiguous in a pooled tree). 1 on success; 0 if the tree is not
+ * empty, sorted input is not strictly ascending, or memory runs out, in
+ * which case the tree is left empty. */
+int      bst_tree_build_sorted(BSTree* tree, const int* keys, int n);
+int      bst_tree_bulk_load(BSTree* tree, const int* keys, int n, int threads);
+
+/* Multiset mode (switch only while the tree is empty; 0 otherwise): a
+ * repeated insert increments the node's count in place and a delete
+ * decrements it, removing the node with its last copy. An insert that
+ * would take a count past BST_MAX_COUNT returns NULL and changes nothing.
+ * Sizes, rank and range counts still count distinct keys. */
+int      bst_set_multiset(BSTree* tree, int enabled);
+int      bst_tree_count(BSTree* tree, int key);
+
+/* Subtree sizes (switch only while the tree is empty; 0 otherwise). Off by
+ * default: inserts and deletes then skip the size walk along the path, and
+ * the tree keeps its node count in `nodes` (the scapegoat rebuild counts
+ * the subtrees it climbs past instead). On: range counts take O(h). */
+int      bst_set_sized(BSTree* tree, int enabled);
+
 #endif
@@ -0,0 +1,19 @@
+#ifndef BULK_H
+#define BULK_H
+
+/* ============================================================================
+ * Bulk Load Preparation
+ *
+ * Parallel LSD radix sort + deduplication of raw int keys. The tree modules
+ * feed the result to their linear-time sorted builders
+ * (bst_bulk_load, avl_bulk_load, rbt_bulk_load).
+ * ============================================================================
+ */
+
+/* Sort and deduplicate keys[0..n) using `threads` threads (<= 0: all cores).
+ * On success *out receives a malloc'd ascending array (caller frees) and the
+ * number of unique keys is returned; returns -1 on allocation failure. The
+ * input is not modified. */
+int bulk_sort_unique(const int *keys, int n, int threads, int **out);
+
+#endif /* BULK_H */
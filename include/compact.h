@@ -0,0 +1,88 @@
+#ifndef COMPACT_H
+#define COMPACT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* ============================================================================
+ * Compact Index-Based Trees
+ *
+ * Nodes live in one contiguous array and link to each other by 32-bit
+ * indices instead of 64-bit pointers. Slot 0 is the NIL sentinel. The spare
+ * high bits of one link word hold the balance data: the AVL height above a
+ * COMPACT_INDEX_BITS index (left word), the RB color above a
+ * COMPACT_RB_INDEX_BITS index (parent word). Both trees hold distinct
+ * keys: inserting a present key returns its node.
+ *
+ *   CompactAVLNode: 12 bytes  (AVLNode: 32 bytes)
+ *   CompactRBNode:  16 bytes  (RBNode:  32 bytes, RBAugNode: 48 bytes)
+ * ============================================================================
+ */
+
+#define COMPACT_NIL         0u
+
+/* AVL: 6 height bits leave 26 index bits (~67M nodes) */
+#define COMPACT_INDEX_BITS  26
+#define COMPACT_INDEX_MASK  ((1u << COMPACT_INDEX_BITS) - 1u)
+#define COMPACT_MAX_NODES   COMPACT_INDEX_MASK
+
+/* RBT: only the color bit is spare, leaving 31 index bits (~2G nodes) */
+#define COMPACT_RB_INDEX_BITS  31
+#define COMPACT_RB_INDEX_MASK  ((1u << COMPACT_RB_INDEX_BITS) - 1u)
+#define COMPACT_RB_MAX_NODES   COMPACT_RB_INDEX_MASK
+
+/* Link word decoding. The height field stores height + 1, so that NIL's
+ * all-zero word reads as -1: heights count edges (leaf = 0), as in avl.h. */
+#define COMPACT_IDX(word)         ((word) & COMPACT_INDEX_MASK)
+#define COMPACT_AVL_HEIGHT(left)  ((int)((left) >> COMPACT_INDEX_BITS) - 1)
+#define COMPACT_RB_IDX(parent)    ((parent) & COMPACT_RB_INDEX_MASK)
+#define COMPACT_RB_COLOR(parent)  ((parent) >> 31)   /* 0 = RED, 1 = BLACK */
+
+typedef struct {
+    int32_t  key;
+    uint32_t left;      /* [height + 1:6 | left index:26] */
+    uint32_t right;
+} CompactAVLNode;
+
+typedef struct {
+    int32_t  key;
+    uint32_t left;
+    uint32_t right;
+    uint32_t parent;    /* [color:1 | parent index:31] */
+} CompactRBNode;
+
+typedef struct {
+    CompactAVLNode *nodes;
+    uint32_t capacity;
+    uint32_t used;       /* Slots ever handed out (including NIL) */
+    uint32_t free_head;  /* Recycled slots, chained through .right */
+    uint32_t root;
+    uint32_t size;
+} CompactAVL;
+
+typedef struct {
+    CompactRBNode *nodes;
+    uint32_t capacity;
+    uint32_t used;       /* Slots ever handed out (including NIL) */
+    uint32_t free_head;  /* Recycled slots, chained through .right */
+    uint32_t root;
+    uint32_t size;
+} CompactRBT;
+
+/* Compact AVL (returns node index; COMPACT_NIL when absent or full).
+ * Height counts edges: leaf = 0, empty = -1. */
+int      compact_avl_init(CompactAVL *tree, uint32_t capacity_hint);
+void     compact_avl_free(CompactAVL *tree);
+uint32_t compact_avl_insert(CompactAVL *tree, int key);
+int      compact_avl_delete(CompactAVL *tree, int key);
+uint32_t compact_avl_search(const CompactAVL *tree, int key);
+int      compact_avl_height(const CompactAVL *tree);
+
+/* Compact Red-Black tree (built for large resident sets) */
+int      compact_rbt_init(CompactRBT *tree, uint32_t capacity_hint);
+void     compact_rbt_free(CompactRBT *tree);
+uint32_t compact_rbt_insert(CompactRBT *tree, int key);
+int      compact_rbt_delete(CompactRBT *tree, int key);
+uint32_t compact_rbt_search(const CompactRBT *tree, int key);
+
+#endif /* COMPACT_H */
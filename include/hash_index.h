@@ -0,0 +1,40 @@
+#ifndef HASH_INDEX_H
+#define HASH_INDEX_H
+
+#include <stddef.h>
+
+/* ============================================================================
+ * Open-Addressing Hash Index
+ *
+ * Side index from int keys to node pointers, kept next to an ordered tree
+ * so that exact lookups cost O(1) expected instead of a root-to-leaf
+ * descent. Linear probing over a power-of-two table that is at most half
+ * full; removal shifts the rest of the probe run back, so there are no
+ * tombstones and lookups never slow down after deletes.
+ *
+ * Values must be non-NULL (NULL marks an empty slot).
+ * ============================================================================
+ */
+
+#define HASH_INDEX_MIN_SLOTS   16
+
+typedef struct HashIndex HashIndex;
+
+/* Lifecycle (capacity: keys to size for without growing) */
+HashIndex* hash_index_create(size_t capacity);
+void       hash_index_destroy(HashIndex *index);
+
+/* Empty the index and size it for `capacity` keys; 0 on allocation failure
+ * (the index is then left as it was) */
+int        hash_index_reset(HashIndex *index, size_t capacity);
+
+/* Maintenance: put maps key to value (replacing any old value) and returns
+ * 0 if the table could not grow; remove returns 1 if the key was present */
+int        hash_index_put(HashIndex *index, int key, void *value);
+int        hash_index_remove(HashIndex *index, int key);
+
+/* Queries: NULL when the key is absent */
+void*      hash_index_get(const HashIndex *index, int key);
+size_t     hash_index_count(const HashIndex *index);
+
+#endif /* HASH_INDEX_H */
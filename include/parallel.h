@@ -0,0 +1,38 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+/* ============================================================================
+ * Minimal Fork-Join Helpers
+ *
+ * Thin wrapper over POSIX threads (Win32 threads on Windows) used by the
+ * bulk loaders and set operations. Every call joins before returning, so
+ * callers never see a thread outlive the work it was given.
+ * ============================================================================
+ */
+
+/* Below this many elements, splitting work across threads is not worth it */
+#define PAR_GRAIN 4096
+
+/* The same cut-off for tree recursions that only know subtree heights */
+#define PAR_GRAIN_HEIGHT 12
+
+typedef void (*ParTask)(void *arg);
+typedef void (*ParRangeTask)(void *arg, int tid);
+
+/* Number of online CPUs (at least 1) */
+int  par_cpu_count(void);
+
+/* Resolve a caller-supplied thread count: <= 0 means "all cores" */
+int  par_threads(int requested);
+
+/* Levels of binary fork-join needed to keep `threads` threads busy */
+int  par_spawn_depth(int threads);
+
+/* Run a(arg_a) on a new thread and b(arg_b) on this one, then join.
+ * Falls back to running both inline if a thread cannot be created. */
+void par_invoke(ParTask a, void *arg_a, ParTask b, void *arg_b);
+
+/* Run fn(arg, tid) for tid in [0, threads) concurrently, then join */
+void par_for(int threads, ParRangeTask fn, void *arg);
+
+#endif /* PARALLEL_H */
@@ -0,0 +1,38 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <stddef.h>
+
+/* ============================================================================
+ * Slab Node Pool
+ *
+ * Fixed-size node allocator owned by one tree (or shared by trees that trade
+ * nodes through split/join). Nodes are carved out of
+ * large cache-line-aligned slabs, freed nodes are kept on a free list for
+ * reuse, and destroying the pool releases whole slabs at once.
+ * ============================================================================
+ */
+
+#define POOL_CACHE_LINE          64
+#define POOL_DEFAULT_SLAB_NODES  1024
+
+typedef struct NodePool NodePool;
+
+/* Lifecycle (nodes_per_slab == 0 selects POOL_DEFAULT_SLAB_NODES).
+ * Trees that exchange nodes (split/join) share one pool: pool_retain adds
+ * an owner and pool_destroy drops one, releasing the slabs with the last. */
+NodePool* pool_create(size_t node_size, size_t nodes_per_slab);
+NodePool* pool_retain(NodePool *pool);
+void      pool_destroy(NodePool *pool);
+
+/* Allocation */
+void*     pool_alloc(NodePool *pool);
+void      pool_free(NodePool *pool, void *node);
+
+/* Statistics */
+size_t    pool_live(const NodePool *pool);
+size_t    pool_slab_count(const NodePool *pool);
+size_t    pool_owners(const NodePool *pool);
+size_t    pool_slab_nodes(const NodePool *pool);
+
+#endif /* POOL_H */
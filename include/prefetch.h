@@ -0,0 +1,32 @@
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+/* ============================================================================
+ * Software Prefetch
+ *
+ * TREE_PREFETCH(addr) asks the CPU to start loading the cache line at addr
+ * (read access, keep in all cache levels). It never faults, so NULL child
+ * pointers can be passed straight in. Compiles to nothing where the
+ * compiler has no prefetch intrinsic.
+ *
+ * The batched searches interleave up to TREE_BATCH_WINDOW lookups in the
+ * style of AMAC: each lookup advances one level per round and prefetches
+ * the child it moves to, so the misses of different lookups overlap. A
+ * finished lookup hands its slot to the next key right away.
+ * ============================================================================
+ */
+
+#if defined(__GNUC__) || defined(__clang__)
+#define TREE_PREFETCH(addr) __builtin_prefetch((addr))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#define TREE_PREFETCH(addr) _mm_prefetch((const char *)(addr), _MM_HINT_T0)
+#else
+#define TREE_PREFETCH(addr) ((void)(addr))
+#endif
+
+/* Lookups kept in flight by the batched searches: enough independent
+ * misses to cover memory latency, few enough to stay in registers/L1 */
+#define TREE_BATCH_WINDOW 16
+
+#endif /* PREFETCH_H */
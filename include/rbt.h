@@ -3,6 +3,10 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <limits.h>
+#include "pool.h"
+#include "bloom.h"
+#include "hash_index.h"
 
 /* Red-Black Tree Color Definition */
 typedef enum {
@@ -10,32 +14,152 @@ typedef enum {
     BLACK = 1
 } Color;
 
-/* Red-Black Tree Node Structure */
+/* Red-Black Tree Node Structure (32 bytes on 64-bit targets) */
 typedef struct RBNode {
     int key;
-    Color color;
+    unsigned color : 1;         /* Color: RED or BLACK */
+    unsigned augmented : 1;     /* Node heads an RBAugNode */
+    unsigned count : 30;        /* Copies of key (multiset mode), else 1 */
     struct RBNode *left;
     struct RBNode *right;
     struct RBNode *parent;
 } RBNode;
 
+/* Node of an augmented tree (48 bytes): the plain node comes first, so an
+ * RBNode* to it is also an RBAugNode* (see RB_AUG) */
+typedef struct {
+    RBNode node;
+    int size;                   /* Nodes in this subtree */
+    int high;                   /* Interval [key, high]; high == key for plain keys */
+    int max_high;               /* Largest high in this subtree */
+} RBAugNode;
+
+#define RB_AUG(n) ((RBAugNode *)(n))
+
+/* Largest count a multiset node can reach; an insert past it fails */
+#define RB_MAX_COUNT ((1 << 30) - 1)
+
 /* Red-Black Tree Structure */
 typedef struct {
     RBNode *root;
     int verbose;
+    NodePool *pool;     /* NULL: nodes use malloc/free */
+    RBNode *max;        /* Cached maximum (NULL: recompute on demand) */
+    RBNode *finger;     /* Last node reached by rbt_finger_search */
+    BloomFilter *bloom; /* Optional negative-lookup filter for rbt_search */
+    HashIndex *index;   /* Optional key -> node side index for rbt_search */
+    int multiset;       /* Duplicates bump count instead of adding nodes */
+    int augmented;      /* Nodes are RBAugNodes (sizes and interval ends) */
+    long long refreshed; /* Ancestors refreshed by insert/delete (augmented only) */
 } RBTree;
 
+/* In-order cursor. RB nodes never move on insert or delete, so a cursor
+ * stays valid until its own node is deleted. */
+typedef struct {
+    RBTree *tree;
+    RBNode *node;
+} RBCursor;
+
+/* Range visitor: return nonzero to continue, 0 to stop */
+typedef int (*RBVisitFn)(RBNode *node, void *arg);
+
 /* Core Operations */
 RBTree* rbt_create(void);
+RBTree* rbt_create_pooled(size_t nodes_per_slab);
 void rbt_destroy(RBTree *tree);
 RBNode* rbt_insert(RBTree *tree, int key);
+RBNode* rbt_insert_hint(RBTree *tree, RBNode *hint, int key);
+int rbt_delete(RBTree *tree, int key);
+void rbt_delete_node(RBTree *tree, RBNode *node);
 RBNode* rbt_search(RBTree *tree, int key);
+int rbt_search_batch(RBTree *tree, const int *keys, int n, RBNode **out);
+RBNode* rbt_finger_search(RBTree *tree, int key);
 void rbt_inorder(RBTree *tree);
 
+/* Bulk Construction (into an empty tree; 0 if it is not empty, sorted
+ * input is not strictly ascending or memory runs out, leaving it empty) */
+int rbt_build_sorted(RBTree *tree, const int *keys, int n);
+int rbt_bulk_load(RBTree *tree, const int *keys, int n, int threads);
+
+/* Split, Join and Set Operations: nodes are relinked between the trees,
+ * never copied, so both trees must draw nodes from the same place (both
+ * on the heap, or one shared pool; an empty unpooled `right` adopts the
+ * pool in rbt_split) and be in the same augmented mode. Otherwise they
+ * return 0 and leave both trees as they were. */
+int rbt_split(RBTree *tree, int key, RBTree *right);
+int rbt_join(RBTree *left, RBTree *right);
+int rbt_union(RBTree *dst, RBTree *src, int threads);
+int rbt_intersection(RBTree *dst, RBTree *src, int threads);
+int rbt_difference(RBTree *dst, RBTree *src, int threads);
+
+/* Neighbour Queries */
+RBNode* rbt_floor(RBTree *tree, int key);
+RBNode* rbt_ceil(RBTree *tree, int key);
+RBNode* rbt_predecessor(RBTree *tree, int key);
+RBNode* rbt_successor(RBTree *tree, int key);
+RBNode* rbt_next(RBNode *node);
+RBNode* rbt_prev(RBNode *node);
+
+/* Cursor and Range Visit (seek lands on the first key >= key) */
+void rbt_cursor_init(RBCursor *c, RBTree *tree);
+RBNode* rbt_cursor_first(RBCursor *c);
+RBNode* rbt_cursor_last(RBCursor *c);
+RBNode* rbt_cursor_seek(RBCursor *c, int key);
+RBNode* rbt_cursor_next(RBCursor *c);
+RBNode* rbt_cursor_prev(RBCursor *c);
+int rbt_visit_range(RBTree *tree, int lo, int hi, RBVisitFn fn, void *arg);
+
+/* Interval Tree Mode: nodes are intervals [key, high] ordered by key (a
+ * plain rbt_insert is [key, key]); remove one with rbt_delete_node.
+ * Intervals with high > key need an augmented tree (NULL otherwise); the
+ * queries also work on a plain tree, whose intervals are all points. */
+RBNode* rbt_insert_interval(RBTree *tree, int lo, int hi);
+RBNode* rbt_interval_search(RBTree *tree, int lo, int hi);
+int rbt_visit_overlaps(RBTree *tree, int lo, int hi, RBVisitFn fn, void *arg);
+int rbt_high(const RBNode *node);
+
+/* Counting, Rank and Selection: O(log n) on an augmented tree. A plain
+ * tree counts a range by walking it; rank returns -1 and select/sample
+ * NULL. */
+int rbt_range_count(RBTree *tree, int lo, int hi);
+int rbt_delete_range(RBTree *tree, int lo, int hi);
+int rbt_rank(RBTree *tree, int key);
+RBNode* rbt_select(RBTree *tree, int k);
+RBNode* rbt_sample(RBTree *tree, unsigned int r);
+
+/* Bloom Filter (bits_per_key <= 0: default). Built from the current keys,
+ * kept current by insert/delete, rebuilt when stale or after bulk
+ * restructuring (build, join, set operations). */
+int rbt_enable_bloom(RBTree *tree, int bits_per_key);
+
+/* Hash Index: exact lookups (rbt_search, rbt_search_batch, rbt_delete) in
+ * O(1) expected. Kept current by every insert/delete path; nodes never
+ * move, so rotations leave it untouched. With duplicate keys it maps the
+ * key to one of its nodes. */
+int rbt_enable_hash_index(RBTree *tree);
+void rbt_disable_hash_index(RBTree *tree);
+
+/* Multiset mode (switch only while the tree is empty; 0 otherwise): a
+ * repeated rbt_insert increments the node's count in place, with no
+ * allocation or fix-up, and rbt_delete decrements it. rbt_delete_node
+ * drops every copy. An insert that would take a count past RB_MAX_COUNT
+ * returns NULL and changes nothing. Sizes, rank and range counts count distinct keys;
+ * rbt_count returns the copies of a key in either mode. */
+int rbt_set_multiset(RBTree *tree, int enabled);
+int rbt_count(RBTree *tree, int key);
+
+/* Augmented mode (switch only while the tree is empty, and for a pooled
+ * tree while no split partner shares its pool; 0 otherwise): nodes grow
+ * from RBNode to RBAugNode to keep subtree sizes and interval ends, which
+ * every rotation and every insert/delete path above the change refreshes.
+ * Plain trees skip that upkeep. */
+int rbt_set_augmented(RBTree *tree, int enabled);
+
 /* Helper Functions */
 void rbt_set_verbose(RBTree *tree, int enabled);
 RBNode* rbt_find_min(RBNode *node);
 RBNode* rbt_find_max(RBNode *node);
+int rbt_size(RBNode *node);   /* O(1) if augmented, else counts the subtree */
 
 /* Internal Rotation and Fix-up */
 void rbt_left_rotate(RBTree *tree, RBNode *node);
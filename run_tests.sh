@@ -20,12 +20,52 @@ FAILED=0
 
 # Compile flags
 CC="gcc"
-CFLAGS="-Wall -Wextra -std=c11 -I./include -lm"
+CFLAGS="-Wall -Wextra -std=c11 -I./include -lm -pthread"
 
 echo "📦 Compiling core libraries..."
 echo "────────────────────────────"
 
 # Compile core sources
+$CC $CFLAGS -c src/pool.c -o build/pool.o 2>&1 | head -20
+if [ $? -ne 0 ]; then
+    echo -e "${RED}✗ Failed to compile pool.c${NC}"
+    ((FAILED++))
+else
+    echo -e "${GREEN}✓ pool.c${NC}"
+fi
+
+$CC $CFLAGS -c src/bloom.c -o build/bloom.o 2>&1 | head -20
+if [ $? -ne 0 ]; then
+    echo -e "${RED}✗ Failed to compile bloom.c${NC}"
+    ((FAILED++))
+else
+    echo -e "${GREEN}✓ bloom.c${NC}"
+fi
+
+$CC $CFLAGS -c src/hash_index.c -o build/hash_index.o 2>&1 | head -20
+if [ $? -ne 0 ]; then
+    echo -e "${RED}✗ Failed to compile hash_index.c${NC}"
+    ((FAILED++))
+else
+    echo -e "${GREEN}✓ hash_index.c${NC}"
+fi
+
+$CC $CFLAGS -c src/parallel.c -o build/parallel.o 2>&1 | head -20
+if [ $? -ne 0 ]; then
+    echo -e "${RED}✗ Failed to compile parallel.c${NC}"
+    ((FAILED++))
+else
+    echo -e "${GREEN}✓ parallel.c${NC}"
+fi
+
+$CC $CFLAGS -c src/bulk.c -o build/bulk.o 2>&1 | head -20
+if [ $? -ne 0 ]; then
+    echo -e "${RED}✗ Failed to compile bulk.c${NC}"
+    ((FAILED++))
+else
+    echo -e "${GREEN}✓ bulk.c${NC}"
+fi
+
 $CC $CFLAGS -c src/bst.c -o build/bst.o 2>&1 | head -20
 if [ $? -ne 0 ]; then
     echo -e "${RED}✗ Failed to compile bst.c${NC}"
@@ -80,7 +120,7 @@ echo "────────────────────────
 
 # Test 1: BST Test
 echo -n "Building bst_test... "
-$CC $CFLAGS src/bst_test.c build/bst.o -o bin/bst_test 2>&1 | head -10
+$CC $CFLAGS src/bst_test.c build/bst.o build/pool.o build/parallel.o build/bulk.o -o bin/bst_test 2>&1 | head -10
 if [ -f bin/bst_test ]; then
     echo -e "${GREEN}✓${NC}"
     ((TOTAL++))
@@ -93,7 +133,7 @@ fi
 
 # Test 2: DEV1 AVL Test
 echo -n "Building dev1_test (AVL)... "
-$CC $CFLAGS src/dev1_test.c build/avl.o -o bin/dev1_test 2>&1 | head -10
+$CC $CFLAGS src/dev1_test.c build/avl.o build/bloom.o build/pool.o build/parallel.o build/bulk.o -o bin/dev1_test 2>&1 | head -10
 if [ -f bin/dev1_test ]; then
     echo -e "${GREEN}✓${NC}"
     ((TOTAL++))
@@ -106,7 +146,7 @@ fi
 
 # Test 3: Unit Test BST
 echo -n "Building test_bst (units)... "
-$CC $CFLAGS tests/test_bst.c build/bst.o -o bin/test_bst 2>&1 | head -10
+$CC $CFLAGS tests/test_bst.c build/bst.o build/pool.o build/parallel.o build/bulk.o -o bin/test_bst 2>&1 | head -10
 if [ -f bin/test_bst ]; then
     echo -e "${GREEN}✓${NC}"
     ((TOTAL++))
@@ -119,7 +159,7 @@ fi
 
 # Test 4: Unit Test AVL
 echo -n "Building test_avl (units)... "
-$CC $CFLAGS tests/test_avl.c build/avl.o -o bin/test_avl 2>&1 | head -10
+$CC $CFLAGS tests/test_avl.c build/avl.o build/bloom.o build/pool.o build/parallel.o build/bulk.o -o bin/test_avl 2>&1 | head -10
 if [ -f bin/test_avl ]; then
     echo -e "${GREEN}✓${NC}"
     ((TOTAL++))
@@ -132,7 +172,7 @@ fi
 
 # Test 5: Unit Test RBT
 echo -n "Building test_rbt (units)... "
-$CC $CFLAGS tests/test_rbt.c build/rbt.o -o bin/test_rbt 2>&1 | head -10
+$CC $CFLAGS tests/test_rbt.c build/rbt.o build/bloom.o build/hash_index.o build/pool.o build/parallel.o build/bulk.o -o bin/test_rbt 2>&1 | head -10
 if [ -f bin/test_rbt ]; then
     echo -e "${GREEN}✓${NC}"
     ((TOTAL++))
@@ -145,7 +185,7 @@ fi
 
 # Test 6: Main Application
 echo -n "Building main app... "
-$CC $CFLAGS src/main.c build/bst.o build/avl.o build/rbt.o build/visualize.o build/app.o build/quiz.o -o bin/tree_explorer 2>&1 | head -10
+$CC $CFLAGS src/main.c build/pool.o build/parallel.o build/bulk.o build/bst.o build/bloom.o build/hash_index.o build/avl.o build/rbt.o build/visualize.o build/app.o build/quiz.o -o bin/tree_explorer 2>&1 | head -10
 if [ -f bin/tree_explorer ]; then
     echo -e "${GREEN}✓${NC}"
     ((TOTAL++))
@@ -264,8 +264,24 @@ void app_operations_menu(TreeType tree_type) {
                 break;
                 
             case 3:
-                printf("\nDelete operation demo (coming soon!)\n");
-                app_pause();
+                printf("\nEnter value to delete: ");
+                scanf("%d", &value);
+                getchar();
+                
+                printf("\n[Deleting %d from %s...]\n", value, tree_names[tree_type]);
+                
+                if (tree_type == TREE_BST) {
+                    bst_root = bst_delete(bst_root, value);
+                    print_bst(bst_root);
+                } else if (tree_type == TREE_AVL) {
+                    avl_root = avl_delete(avl_root, value);
+                    print_avl(avl_root);
+                } else if (tree_type == TREE_RBT) {
+                    if (!rbt_delete(rbt, value)) printf("✗ Not found!\n");
+                    print_rbt(rbt->root);
+                }
+                
+                if (global_state.step_mode) app_pause();
                 break;
                 
             case 4:
@@ -1,9 +1,31 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "avl.h"
+#include "bulk.h"
+#include "parallel.h"
+#include "prefetch.h"
 
+/* Height counts edges: leaf = 0, empty = -1 */
 int avl_height(AVLNode* node) {
-    return node ? node->height : 0;
+    return node ? node->height : -1;
+}
+
+/* Live nodes: stored in sized nodes, counted otherwise */
+int avl_size(AVLNode* node) {
+    if (!node) return 0;
+    if (node->sized) return node->size;
+    return !node->dead + avl_size(node->left) + avl_size(node->right);
+}
+
+/* Own entry in a subtree size: tombstones do not count */
+static int avl_live(AVLNode* node) {
+    return !node->dead;
+}
+
+/* Mode for nodes added through the node-level API: the tree's own, and
+ * sized for a new tree */
+static int avl_sized(AVLNode* root) {
+    return root ? root->sized : 1;
 }
 
 int max(int a, int b) {
@@ -23,6 +45,10 @@ AVLNode* rotate_right(AVLNode* y) {
 
     y->height = 1 + max(avl_height(y->left), avl_height(y->right));
     x->height = 1 + max(avl_height(x->left), avl_height(x->right));
+    if (y->sized) {
+        x->size = y->size;
+        y->size = avl_live(y) + avl_size(y->left) + avl_size(y->right);
+    }
 
     return x;
 }
@@ -35,50 +61,151 @@ AVLNode* rotate_left(AVLNode* x) {
 
     x->height = 1 + max(avl_height(x->left), avl_height(x->right));
     y->height = 1 + max(avl_height(y->left), avl_height(y->right));
+    if (x->sized) {
+        y->size = x->size;
+        x->size = avl_live(x) + avl_size(x->left) + avl_size(x->right);
+    }
 
     return y;
 }
 
-AVLNode* avl_insert(AVLNode* node, int key) {
-    if (!node) {
-        AVLNode* n = malloc(sizeof(AVLNode));
-        n->key = key;
-        n->left = n->right = NULL;
-        n->height = 1;
-        return n;
-    }
+/* Node storage: from the tree's pool when it has one, else the heap */
+static AVLNode* avl_node_alloc(NodePool* pool) {
+    return pool ? pool_alloc(pool) : malloc(sizeof(AVLNode));
+}
 
-    if (key < node->key)
-        node->left = avl_insert(node->left, key);
-    else if (key > node->key)
-        node->right = avl_insert(node->right, key);
-    else
-        return node; // no duplicates
+static void avl_node_release(NodePool* pool, AVLNode* node) {
+    if (pool) pool_free(pool, node);
+    else free(node);
+}
 
+/* Recompute height (and size, if kept) from the children */
+static void avl_update(AVLNode* node) {
     node->height = 1 + max(avl_height(node->left), avl_height(node->right));
+    if (node->sized) node->size = avl_live(node) + avl_size(node->left) + avl_size(node->right);
+}
+
+/* Single or double rotation for a node whose balance factor is +-2 */
+static AVLNode* avl_rebalance(AVLNode* node) {
     int bf = avl_balance_factor(node);
 
-    // LL
-    if (bf > 1 && key < node->left->key)
+    if (bf > 1) {
+        // LR
+        if (avl_balance_factor(node->left) < 0)
+            node->left = rotate_left(node->left);
+        // LL
         return rotate_right(node);
-
-    // RR
-    if (bf < -1 && key > node->right->key)
+    }
+    if (bf < -1) {
+        // RL
+        if (avl_balance_factor(node->right) > 0)
+            node->right = rotate_right(node->right);
+        // RR
         return rotate_left(node);
+    }
+    return node;
+}
 
-    // LR
-    if (bf > 1 && key > node->left->key) {
-        node->left = rotate_left(node->left);
-        return rotate_right(node);
+/* Walk back up the recorded path, fixing heights and rotating where needed.
+ * Stops as soon as a subtree's height is unchanged: nothing above it can
+ * have changed either. */
+static void avl_retrace(AVLNode** path[], int depth) {
+    while (depth > 0) {
+        AVLNode** link = path[--depth];
+        AVLNode* node = *link;
+        int old_height = node->height;
+
+        avl_update(node);
+        int bf = avl_balance_factor(node);
+        if (bf > 1 || bf < -1) {
+            node = avl_rebalance(node);
+            *link = node;
+        }
+
+        if (node->height == old_height) break;
     }
+}
 
-    // RL
-    if (bf < -1 && key < node->right->key) {
-        node->right = rotate_right(node->right);
-        return rotate_left(node);
+/* Iterative insert: one descent records the links on the path, one bottom-up
+ * retrace that ends at the first unchanged height (at most one rotation).
+ * Only a sized tree walks the whole path to bump sizes. *created tells a
+ * new node from an existing one. */
+static AVLNode* avl_insert_in(NodePool* pool, AVLNode** root, int key,
+                              int sized, int* created) {
+    AVLNode** path[AVL_MAX_DEPTH];
+    int depth = 0;
+    AVLNode** link = root;
+
+    *created = 0;
+    while (*link) {
+        AVLNode* cur = *link;
+        if (key == cur->key)
+            return cur; // no duplicates
+        path[depth++] = link;
+        link = key < cur->key ? &cur->left : &cur->right;
     }
 
-    return node;
+    AVLNode* n = avl_node_alloc(pool);
+    if (!n) return NULL;
+    n->key = key;
+    n->left = n->right = NULL;
+    n->height = 0;
+    n->size = 1;
+    n->dead = 0;
+    n->count = 1;
+    n->sized = sized;
+    *link = n;
+    *created = 1;
+
+    if (sized)
+        for (int i = 0; i < depth; i++)
+            (*path[i])->size++;
+    avl_retrace(path, depth);
+    return n;
+}
+
+/* Iterative delete: a node with two children takes its successor's key and
+ * the successor is unlinked in the same descent. */
+static int avl_delete_in(NodePool* pool, AVLNode** root, int key) {
+    AVLNode** path[AVL_MAX_DEPTH];
+    int depth = 0;
+    AVLNode** link = root;
+
+    while (*link && (*link)->key != key) {
+        path[depth++] = link;
+        link = key < (*link)->key ? &(*link)->left : &(*link)->right;
+    }
+
+    AVLNode* node = *link;
+    if (!node) return 0;
+    int sized = node->sized;
+
+    if (!node->left || !node->right) {
+        *link = node->left ? node->left : node->right;
+    } else {
+        path[depth++] = link;
+        AVLNode** succ_link = &node->right;
+        while ((*succ_link)->left) {
+            path[depth++] = succ_link;
+            succ_link = &(*succ_link)->left;
+        }
+
+        AVLNode* succ = *succ_link;
+        *succ_link = succ->right;
+        node->key = succ->key;
+        node->dead = succ->dead;
+        node->count = succ->count;
+        node = succ;
+    }
+
+    avl_node_release(pool, node);
+    if (sized)  /* bottom-up: the node that took the successor's key may
+                 * have changed liveness too */
+        for (int i = depth; i-- > 0;)
+            (*path[i])->size = avl_live(*path[i]) + avl_size((*path[i])->left) +
+                               avl_size((*path[i])->right);
+    avl_retrace(path, depth);
+    return 1;
 }
 
 AVLNode* avl_min(AVLNode* node) {
@@ -88,62 +215,1222 @@ AVLNode* avl_min(AVLNode* node) {
     return current;
 }
 
+AVLNode* avl_insert(AVLNode* node, int key) {
+    int created;
+    avl_insert_in(NULL, &node, key, avl_sized(node), &created);
+    return node;
+}
+
 AVLNode* avl_delete(AVLNode* node, int key) {
-    if (!node) return NULL;
+    avl_delete_in(NULL, &node, key);
+    return node;
+}
 
-    if (key < node->key)
-        node->left = avl_delete(node->left, key);
-    else if (key > node->key)
-        node->right = avl_delete(node->right, key);
-    else {
-        if (!node->left) {
-            AVLNode* temp = node->right;
-            free(node);
-            return temp;
-        }
-        if (!node->right) {
-            AVLNode* temp = node->left;
-            free(node);
-            return temp;
-        }
-        AVLNode* succ = avl_min(node->right);
-        node->key = succ->key;
-        node->right = avl_delete(node->right, succ->key);
+/* Node holding key, tombstone or not */
+static AVLNode* avl_find(AVLNode* node, int key) {
+    while (node && node->key != key)
+        node = key < node->key ? node->left : node->right;
+    return node;
+}
+
+AVLNode* avl_search(AVLNode* node, int key) {
+    node = avl_find(node, key);
+    return node && !node->dead ? node : NULL;
+}
+
+/* Interleaved lookups (see prefetch.h): out[i] = avl_search(root, keys[i]).
+ * Returns the number of keys found. */
+int avl_search_batch(AVLNode* root, const int* keys, int n, AVLNode** out) {
+    AVLNode* cur[TREE_BATCH_WINDOW];
+    int idx[TREE_BATCH_WINDOW];
+    int next = 0, active = 0, found = 0;
+
+    for (; active < TREE_BATCH_WINDOW && next < n; active++) {
+        idx[active] = next++;
+        cur[active] = root;
+    }
+
+    while (active > 0) {
+        for (int s = 0; s < active; ) {
+            AVLNode* node = cur[s];
+            int key = keys[idx[s]];
+            if (node && node->key != key) {
+                node = key < node->key ? node->left : node->right;
+                TREE_PREFETCH(node);
+                cur[s++] = node;
+                continue;
+            }
+
+            /* Finished: record, then refill the slot or close the gap */
+            out[idx[s]] = node && !node->dead ? node : NULL;
+            found += out[idx[s]] != NULL;
+            if (next < n) {
+                idx[s] = next++;
+                cur[s++] = root;
+            } else {
+                active--;
+                idx[s] = idx[active];
+                cur[s] = cur[active];
+            }
+        }
+    }
+    return found;
+}
+
+static void avl_free_in(NodePool* pool, AVLNode* node) {
+    if (!node) return;
+    avl_free_in(pool, node->left);
+    avl_free_in(pool, node->right);
+    avl_node_release(pool, node);
+}
+
+void avl_free(AVLNode* node) {
+    avl_free_in(NULL, node);
+}
+
+/* ============================================================================
+ * Split / Join
+ *
+ * join3(l, k, r) descends the spine of the taller tree until the heights are
+ * within one, hangs k there and rebalances on the way back up: O(|h(l) -
+ * h(r)| + 1). Split cuts along the search path and joins the pieces back
+ * together; the join costs telescope to O(log n).
+ * ============================================================================
+ */
+
+/* l is taller: walk its right spine */
+static AVLNode* avl_join_right(AVLNode* l, AVLNode* k, AVLNode* r) {
+    AVLNode* c = l->right;
+
+    if (avl_height(c) <= avl_height(r) + 1) {
+        k->left = c;
+        k->right = r;
+        avl_update(k);
+        l->right = k;
+        if (k->height <= avl_height(l->left) + 1) {
+            avl_update(l);
+            return l;
+        }
+        l->right = rotate_right(k);
+        avl_update(l);
+        return rotate_left(l);
+    }
+
+    l->right = avl_join_right(c, k, r);
+    avl_update(l);
+    if (avl_height(l->right) <= avl_height(l->left) + 1) return l;
+    return rotate_left(l);
+}
+
+/* r is taller: walk its left spine */
+static AVLNode* avl_join_left(AVLNode* l, AVLNode* k, AVLNode* r) {
+    AVLNode* c = r->left;
+
+    if (avl_height(c) <= avl_height(l) + 1) {
+        k->left = l;
+        k->right = c;
+        avl_update(k);
+        r->left = k;
+        if (k->height <= avl_height(r->right) + 1) {
+            avl_update(r);
+            return r;
+        }
+        r->left = rotate_left(k);
+        avl_update(r);
+        return rotate_right(r);
+    }
+
+    r->left = avl_join_left(l, k, c);
+    avl_update(r);
+    if (avl_height(r->left) <= avl_height(r->right) + 1) return r;
+    return rotate_right(r);
+}
+
+/* Keys of l < k->key <= keys of r */
+static AVLNode* avl_join3(AVLNode* l, AVLNode* k, AVLNode* r) {
+    if (avl_height(l) > avl_height(r) + 1) return avl_join_right(l, k, r);
+    if (avl_height(r) > avl_height(l) + 1) return avl_join_left(l, k, r);
+    k->left = l;
+    k->right = r;
+    avl_update(k);
+    return k;
+}
+
+/* Detach the maximum node of a non-empty tree into *out */
+static AVLNode* avl_remove_max(AVLNode* node, AVLNode** out) {
+    if (!node->right) {
+        *out = node;
+        return node->left;
+    }
+    node->right = avl_remove_max(node->right, out);
+    avl_update(node);
+    return avl_rebalance(node);
+}
+
+AVLNode* avl_join(AVLNode* left, AVLNode* right) {
+    if (!left) return right;
+    if (!right) return left;
+
+    AVLNode* k;
+    left = avl_remove_max(left, &k);
+    return avl_join3(left, k, right);
+}
+
+/* Split into keys < key and keys > key; the node holding key (if any) is
+ * detached and returned */
+static AVLNode* avl_split3(AVLNode* root, int key, AVLNode** left, AVLNode** right) {
+    if (!root) {
+        *left = *right = NULL;
+        return NULL;
     }
 
+    AVLNode* l = root->left;
+    AVLNode* r = root->right;
+    AVLNode* mid;
+    AVLNode* found;
+    if (key == root->key) {
+        *left = l;
+        *right = r;
+        return root;
+    }
+    if (key < root->key) {
+        found = avl_split3(l, key, left, &mid);
+        *right = avl_join3(mid, root, r);
+    } else {
+        found = avl_split3(r, key, &mid, right);
+        *left = avl_join3(l, root, mid);
+    }
+    return found;
+}
+
+void avl_split(AVLNode* root, int key, AVLNode** left, AVLNode** right) {
+    AVLNode* found = avl_split3(root, key, left, right);
+    if (found) *right = avl_join3(NULL, found, *right);
+}
+
+/* ============================================================================
+ * Set Operations
+ *
+ * Divide and conquer on the root of a: split b around a->key, recurse on
+ * the two halves (in parallel near the top) and join the results with
+ * a's root or without it. Work O(m log(n/m + 1)) for sizes m <= n.
+ *
+ * Workers never release nodes: dropped ones are chained through ->right
+ * and released on the calling thread once the recursion is done.
+ * ============================================================================
+ */
+
+/* Nodes cut loose by one task, chained through ->right */
+typedef struct {
+    AVLNode* head;
+    AVLNode* tail;
+} AVLDropList;
+
+static void avl_drop(AVLDropList* d, AVLNode* node) {
+    node->right = d->head;
+    d->head = node;
+    if (!d->tail) d->tail = node;
+}
+
+static void avl_drop_tree(AVLDropList* d, AVLNode* node) {
+    if (!node) return;
+    avl_drop_tree(d, node->left);
+    AVLNode* right = node->right;
+    avl_drop(d, node);
+    avl_drop_tree(d, right);
+}
+
+static void avl_drop_merge(AVLDropList* d, AVLDropList* from) {
+    if (!from->head) return;
+    from->tail->right = d->head;
+    d->head = from->head;
+    if (!d->tail) d->tail = from->tail;
+}
+
+static void avl_drop_release(NodePool* pool, AVLDropList* d) {
+    while (d->head) {
+        AVLNode* next = d->head->right;
+        avl_node_release(pool, d->head);
+        d->head = next;
+    }
+    d->tail = NULL;
+}
+
+typedef enum { AVL_UNION, AVL_INTERSECTION, AVL_DIFFERENCE } AVLSetOp;
+
+typedef struct {
+    AVLSetOp op;
+    AVLNode* a;
+    AVLNode* b;
+    int spawn;          /* Fork-join levels still allowed */
+    AVLNode* out;
+    AVLDropList dropped;
+} AVLSetTask;
+
+static void avl_set_op(AVLSetTask* t);
+
+static void avl_set_task(void* arg) {
+    avl_set_op(arg);
+}
+
+static void avl_set_op(AVLSetTask* t) {
+    AVLNode* a = t->a;
+    AVLNode* b = t->b;
+
+    /* Union and intersection are symmetric: split the larger tree by the
+     * root of the smaller one */
+    if (t->op != AVL_DIFFERENCE && avl_height(a) > avl_height(b)) {
+        a = t->b;
+        b = t->a;
+    }
+
+    if (!a || !b) {
+        if (t->op == AVL_UNION) {
+            t->out = a ? a : b;
+        } else if (t->op == AVL_DIFFERENCE) {
+            avl_drop_tree(&t->dropped, b);
+            t->out = a;
+        } else {
+            avl_drop_tree(&t->dropped, a);
+            avl_drop_tree(&t->dropped, b);
+            t->out = NULL;
+        }
+        return;
+    }
+
+    AVLNode *l2, *r2;
+    AVLNode* found = avl_split3(b, a->key, &l2, &r2);
+    AVLSetTask left = { t->op, a->left, l2, t->spawn - 1, NULL, { NULL, NULL } };
+    AVLSetTask right = { t->op, a->right, r2, t->spawn - 1, NULL, { NULL, NULL } };
+
+    if (t->spawn > 0 && a->height >= PAR_GRAIN_HEIGHT) {
+        par_invoke(avl_set_task, &left, avl_set_task, &right);
+    } else {
+        left.spawn = right.spawn = 0;
+        avl_set_op(&left);
+        avl_set_op(&right);
+    }
+    avl_drop_merge(&t->dropped, &left.dropped);
+    avl_drop_merge(&t->dropped, &right.dropped);
+
+    int keep = t->op == AVL_UNION || (t->op == AVL_INTERSECTION) == (found != NULL);
+    if (found) avl_drop(&t->dropped, found);
+    if (keep) {
+        t->out = avl_join3(left.out, a, right.out);
+    } else {
+        avl_drop(&t->dropped, a);
+        t->out = avl_join(left.out, right.out);
+    }
+}
+
+static AVLNode* avl_set_apply(AVLSetOp op, AVLNode* a, AVLNode* b, int threads) {
+    AVLSetTask t = { op, a, b, par_spawn_depth(par_threads(threads)), NULL,
+                     { NULL, NULL } };
+    avl_set_op(&t);
+    avl_drop_release(NULL, &t.dropped);
+    return t.out;
+}
+
+AVLNode* avl_union(AVLNode* a, AVLNode* b, int threads) {
+    return avl_set_apply(AVL_UNION, a, b, threads);
+}
+
+AVLNode* avl_intersection(AVLNode* a, AVLNode* b, int threads) {
+    return avl_set_apply(AVL_INTERSECTION, a, b, threads);
+}
+
+AVLNode* avl_difference(AVLNode* a, AVLNode* b, int threads) {
+    return avl_set_apply(AVL_DIFFERENCE, a, b, threads);
+}
+
+/* ============================================================================
+ * Batch Apply
+ *
+ * A sorted batch is merged in one pass: the ops are partitioned around the
+ * root key (binary search), both halves are applied to the subtrees (in
+ * parallel near the top), and join3 / join put the root back or drop it,
+ * rebalancing on the way up. Where a subtree runs out, the remaining
+ * inserts are built directly as a balanced subtree. Work O(m log(n/m + 1)).
+ *
+ * As with the set operations, dropped nodes are chained through ->right
+ * and released on the calling thread; a pooled tree also takes its new
+ * nodes from slots carved out before the threads start.
+ * ============================================================================
+ */
+
+typedef struct {
+    NodePool* pool;
+    const AVLBatchOp* ops;
+    const int* ins_keys;        /* Keys of the insert ops, in order */
+    const int* ins_before;      /* ins_before[i]: insert ops in ops[0, i) */
+    AVLNode** slots;            /* A node per insert op, or NULL */
+    int sized;                  /* Mode of the nodes built */
+} AVLBatch;
+
+typedef struct {
+    const AVLBatch* batch;
+    AVLNode* root;
+    int lo, hi;                 /* Op range */
+    int spawn;                  /* Fork-join levels still allowed */
+    AVLNode* out;
+    int changed;                /* Keys inserted or (live ones) deleted */
+    int cleared;                /* Tombstones revived or removed */
+    int linked;                 /* Nodes built minus nodes dropped */
+    AVLDropList dropped;
+} AVLBatchTask;
+
+static void avl_batch_merge(AVLBatchTask* t, AVLBatchTask* from) {
+    t->changed += from->changed;
+    t->cleared += from->cleared;
+    t->linked += from->linked;
+    avl_drop_merge(&t->dropped, &from->dropped);
+}
+
+/* Balanced subtree of the insert keys ins_keys[lo..hi] */
+static AVLNode* avl_batch_build(const AVLBatch* b, int lo, int hi, int* built) {
+    if (lo > hi) return NULL;
+
+    int mid = lo + (hi - lo) / 2;
+    AVLNode* left = avl_batch_build(b, lo, mid - 1, built);
+    AVLNode* right = avl_batch_build(b, mid + 1, hi, built);
+
+    AVLNode* node;
+    if (b->slots) {
+        node = b->slots[mid];
+        b->slots[mid] = NULL;
+    } else {
+        node = avl_node_alloc(b->pool);
+    }
+    if (!node) return avl_join(left, right);
+
+    node->key = b->ins_keys[mid];
+    node->dead = 0;
+    node->count = 1;
+    node->sized = b->sized;
+    node->left = left;
+    node->right = right;
+    avl_update(node);
+    (*built)++;
+    return node;
+}
+
+static void avl_batch_apply(AVLBatchTask* t);
+
+static void avl_batch_task(void* arg) {
+    avl_batch_apply(arg);
+}
+
+static void avl_batch_apply(AVLBatchTask* t) {
+    const AVLBatch* b = t->batch;
+    AVLNode* node = t->root;
+    int lo = t->lo, hi = t->hi;
+
+    if (lo > hi) {
+        t->out = node;
+        return;
+    }
+    if (!node) {
+        int built = 0;
+        t->out = avl_batch_build(b, b->ins_before[lo], b->ins_before[hi + 1] - 1,
+                                 &built);
+        t->changed += built;
+        t->linked += built;
+        return;
+    }
+
+    /* First op at or after the root key */
+    int a = lo, z = hi + 1;
+    while (a < z) {
+        int m = a + (z - a) / 2;
+        if (b->ops[m].key < node->key) a = m + 1;
+        else z = m;
+    }
+    int at = (a <= hi && b->ops[a].key == node->key) ? a : -1;
+
+    AVLBatchTask left = { b, node->left, lo, a - 1, t->spawn - 1,
+                          NULL, 0, 0, 0, { NULL, NULL } };
+    AVLBatchTask right = { b, node->right, at >= 0 ? a + 1 : a, hi, t->spawn - 1,
+                           NULL, 0, 0, 0, { NULL, NULL } };
+    if (t->spawn > 0 && hi - lo >= PAR_GRAIN) {
+        par_invoke(avl_batch_task, &left, avl_batch_task, &right);
+    } else {
+        left.spawn = right.spawn = 0;
+        avl_batch_apply(&left);
+        avl_batch_apply(&right);
+    }
+    avl_batch_merge(t, &left);
+    avl_batch_merge(t, &right);
+
+    if (at >= 0 && b->ops[at].kind == AVL_BATCH_DELETE) {
+        if (node->dead) t->cleared++;
+        else t->changed++;
+        t->linked--;
+        avl_drop(&t->dropped, node);
+        t->out = avl_join(left.out, right.out);
+        return;
+    }
+    if (at >= 0 && node->dead) {
+        node->dead = 0;
+        node->count = 1;
+        t->cleared++;
+        t->changed++;
+    }
+    t->out = avl_join3(left.out, node, right.out);
+}
+
+/* Shared driver; returns the keys changed, or -1 if the batch is not
+ * strictly ascending or memory runs out (the tree is then untouched).
+ * *linked is the change in the number of nodes. */
+static int avl_apply_in(NodePool* pool, int sized, AVLNode** root, const AVLBatchOp* ops,
+                        int m, int threads, int* cleared, int* linked) {
+    *cleared = 0;
+    *linked = 0;
+    if (m < 0 || (m > 0 && !ops)) return -1;
+    for (int i = 1; i < m; i++)
+        if (ops[i].key <= ops[i - 1].key) return -1;
+    if (m == 0) return 0;
+
+    int* ins_keys = malloc(sizeof(int) * (size_t)m);
+    int* ins_before = malloc(sizeof(int) * ((size_t)m + 1));
+    if (!ins_keys || !ins_before) {
+        free(ins_keys);
+        free(ins_before);
+        return -1;
+    }
+    int inserts = 0;
+    for (int i = 0; i < m; i++) {
+        ins_before[i] = inserts;
+        if (ops[i].kind == AVL_BATCH_INSERT) ins_keys[inserts++] = ops[i].key;
+    }
+    ins_before[m] = inserts;
+
+    /* The pool is single-threaded: carve a node for every insert up front */
+    int spawn = par_spawn_depth(par_threads(threads));
+    AVLBatch batch = { pool, ops, ins_keys, ins_before, NULL, sized };
+    if (pool && spawn > 0 && inserts > 0) {
+        batch.slots = malloc(sizeof(AVLNode*) * (size_t)inserts);
+        for (int i = 0; batch.slots && i < inserts; i++) {
+            batch.slots[i] = avl_node_alloc(pool);
+            if (!batch.slots[i]) {
+                while (i-- > 0) avl_node_release(pool, batch.slots[i]);
+                free(batch.slots);
+                batch.slots = NULL;
+            }
+        }
+        if (!batch.slots) {
+            free(ins_keys);
+            free(ins_before);
+            return -1;
+        }
+    }
+
+    AVLBatchTask t = { &batch, *root, 0, m - 1, spawn, NULL, 0, 0, 0, { NULL, NULL } };
+    avl_batch_apply(&t);
+    *root = t.out;
+    avl_drop_release(pool, &t.dropped);
+    if (batch.slots) {
+        for (int i = 0; i < inserts; i++)
+            if (batch.slots[i]) avl_node_release(pool, batch.slots[i]);
+        free(batch.slots);
+    }
+    free(ins_keys);
+    free(ins_before);
+    *cleared = t.cleared;
+    *linked = t.linked;
+    return t.changed;
+}
+
+AVLNode* avl_apply_batch(AVLNode* root, const AVLBatchOp* ops, int m, int threads) {
+    int cleared, linked;
+    avl_apply_in(NULL, avl_sized(root), &root, ops, m, threads, &cleared, &linked);
+    return root;
+}
+
+/* ============================================================================
+ * Range Queries
+ * ============================================================================
+ */
+
+/* Keys below key (or up to key when inclusive), summing left sizes */
+static int avl_count_below(AVLNode* node, int key, int inclusive) {
+    int count = 0;
+    while (node) {
+        if (key < node->key || (key == node->key && !inclusive)) {
+            node = node->left;
+        } else {
+            count += avl_size(node->left) + avl_live(node);
+            node = node->right;
+        }
+    }
+    return count;
+}
+
+static int avl_count_one(AVLNode* node, void* arg) {
+    (void)node;
+    (void)arg;
+    return 1;
+}
+
+/* Without sizes the range is walked instead: O(log n + k) */
+int avl_range_count(AVLNode* root, int lo, int hi) {
+    if (lo > hi) return 0;
+    if (root && !root->sized) return avl_visit_range(root, lo, hi, avl_count_one, NULL);
+    return avl_count_below(root, hi, 1) - avl_count_below(root, lo, 0);
+}
+
+/* Cut out [lo, hi] with two splits, free it, and join the outer parts:
+ * the tree is rebalanced once by the join, not once per key. */
+static int avl_delete_range_in(NodePool* pool, AVLNode** root, int lo, int hi) {
+    if (lo > hi || !*root) return 0;
+
+    AVLNode *below, *rest, *mid, *above;
+    avl_split(*root, lo, &below, &rest);
+    AVLNode* last = avl_split3(rest, hi, &mid, &above);
+    if (last) last->left = last->right = NULL;
+
+    int removed = avl_size(mid) + (last && avl_live(last));
+    avl_free_in(pool, mid);
+    avl_free_in(pool, last);
+    *root = avl_join(below, above);
+    return removed;
+}
+
+AVLNode* avl_delete_range(AVLNode* root, int lo, int hi) {
+    avl_delete_range_in(NULL, &root, lo, hi);
+    return root;
+}
+
+/* ============================================================================
+ * Order Statistics
+ * ============================================================================
+ */
+
+/* Number of keys smaller than key (its 0-based position if present), or
+ * -1 without sizes */
+int avl_rank(AVLNode* root, int key) {
+    if (root && !root->sized) return -1;
+    return avl_count_below(root, key, 0);
+}
+
+/* The k-th smallest node (k from 0), or NULL when k is out of range or
+ * the tree keeps no sizes */
+AVLNode* avl_select(AVLNode* root, int k) {
+    if (!root || !root->sized || k < 0 || k >= root->size) return NULL;
+
+    while (root) {
+        int left = avl_size(root->left);
+        if (k == left && avl_live(root)) break;
+        if (k < left) {
+            root = root->left;
+        } else {
+            k -= left + avl_live(root);
+            root = root->right;
+        }
+    }
+    return root;
+}
+
+/* Node at rank r mod n: uniform over the tree when r is a uniform draw */
+AVLNode* avl_sample(AVLNode* root, unsigned int r) {
+    if (!root || !root->sized || root->size == 0) return NULL;
+    return avl_select(root, (int)(r % (unsigned int)root->size));
+}
+
+/* ============================================================================
+ * Neighbour Queries
+ * ============================================================================
+ */
+
+/* One descent remembering the last node on the wanted side of key: the
+ * closest key below (or above) it, or key itself when inclusive */
+static AVLNode* avl_nearest(AVLNode* node, int key, int below, int inclusive) {
+    AVLNode* best = NULL;
+    while (node) {
+        if (node->key == key && inclusive) return node;
+        if (below ? node->key < key : node->key > key) {
+            best = node;
+            node = below ? node->right : node->left;
+        } else {
+            node = below ? node->left : node->right;
+        }
+    }
+    return best;
+}
+
+/* Step past tombstones with further strict queries */
+static AVLNode* avl_nearest_live(AVLNode* root, int key, int below, int inclusive) {
+    AVLNode* node = avl_nearest(root, key, below, inclusive);
+    while (node && node->dead)
+        node = avl_nearest(root, node->key, below, 0);
+    return node;
+}
+
+AVLNode* avl_floor(AVLNode* root, int key) {
+    return avl_nearest_live(root, key, 1, 1);
+}
+
+AVLNode* avl_ceil(AVLNode* root, int key) {
+    return avl_nearest_live(root, key, 0, 1);
+}
+
+AVLNode* avl_predecessor(AVLNode* root, int key) {
+    return avl_nearest_live(root, key, 1, 0);
+}
+
+AVLNode* avl_successor(AVLNode* root, int key) {
+    return avl_nearest_live(root, key, 0, 0);
+}
+
+/* ============================================================================
+ * Cursor
+ *
+ * The cursor keeps the whole root-to-node path (bounded by AVL_MAX_DEPTH),
+ * so it can step both ways: forward goes to the leftmost node of the right
+ * subtree, or climbs until it leaves a left subtree (backward mirrors
+ * this). Each step prefetches the subtree the following step will enter.
+ * Tombstones are stepped over.
+ * ============================================================================
+ */
+
+void avl_cursor_init(AVLCursor* c, AVLNode* root) {
+    c->root = root;
+    c->depth = 0;
+}
+
+static AVLNode* avl_cursor_top(const AVLCursor* c) {
+    return c->depth ? c->path[c->depth - 1] : NULL;
+}
+
+/* Push node and its left (or right) spine; the spine end is current */
+static AVLNode* avl_cursor_descend(AVLCursor* c, AVLNode* node, int leftward) {
+    for (; node; node = leftward ? node->left : node->right)
+        c->path[c->depth++] = node;
+
+    node = avl_cursor_top(c);
+    if (node) TREE_PREFETCH(leftward ? node->right : node->left);
+    return node;
+}
+
+static AVLNode* avl_cursor_move(AVLCursor* c, int forward);
+
+/* Keep moving while the cursor sits on a tombstone */
+static AVLNode* avl_cursor_live(AVLCursor* c, AVLNode* node, int forward) {
+    while (node && node->dead)
+        node = avl_cursor_move(c, forward);
+    return node;
+}
+
+AVLNode* avl_cursor_first(AVLCursor* c) {
+    c->depth = 0;
+    return avl_cursor_live(c, avl_cursor_descend(c, c->root, 1), 1);
+}
+
+AVLNode* avl_cursor_last(AVLCursor* c) {
+    c->depth = 0;
+    return avl_cursor_live(c, avl_cursor_descend(c, c->root, 0), 0);
+}
+
+AVLNode* avl_cursor_seek(AVLCursor* c, int key) {
+    AVLNode* node = c->root;
+    int keep = 0;   /* Path length up to the best candidate so far */
+
+    c->depth = 0;
+    while (node) {
+        c->path[c->depth++] = node;
+        if (key == node->key) {
+            keep = c->depth;
+            break;
+        }
+        if (key < node->key) {
+            keep = c->depth;
+            node = node->left;
+        } else {
+            node = node->right;
+        }
+    }
+
+    c->depth = keep;
+    node = avl_cursor_top(c);
+    if (node) TREE_PREFETCH(node->right);
+    return avl_cursor_live(c, node, 1);
+}
+
+/* Step in order (forward) or in reverse */
+static AVLNode* avl_cursor_move(AVLCursor* c, int forward) {
+    AVLNode* node = avl_cursor_top(c);
     if (!node) return NULL;
 
-    node->height = 1 + max(avl_height(node->left), avl_height(node->right));
-    int bf = avl_balance_factor(node);
+    AVLNode* ahead = forward ? node->right : node->left;
+    if (ahead) return avl_cursor_descend(c, ahead, forward);
 
-    if (bf > 1 && avl_balance_factor(node->left) >= 0)
-        return rotate_right(node);
-    if (bf > 1 && avl_balance_factor(node->left) < 0) {
-        node->left = rotate_left(node->left);
-        return rotate_right(node);
+    /* Climb until we leave a subtree on the side we came from */
+    AVLNode* child;
+    do {
+        child = c->path[--c->depth];
+        node = avl_cursor_top(c);
+    } while (node && (forward ? node->right : node->left) == child);
+
+    if (node) TREE_PREFETCH(forward ? node->right : node->left);
+    return node;
+}
+
+AVLNode* avl_cursor_next(AVLCursor* c) {
+    return avl_cursor_live(c, avl_cursor_move(c, 1), 1);
+}
+
+AVLNode* avl_cursor_prev(AVLCursor* c) {
+    return avl_cursor_live(c, avl_cursor_move(c, 0), 0);
+}
+
+int avl_visit_range(AVLNode* root, int lo, int hi, AVLVisitFn fn, void* arg) {
+    AVLCursor c;
+    int visited = 0;
+
+    avl_cursor_init(&c, root);
+    for (AVLNode* node = avl_cursor_seek(&c, lo); node && node->key <= hi;
+         node = avl_cursor_next(&c)) {
+        visited++;
+        if (!fn(node, arg)) break;
     }
-    if (bf < -1 && avl_balance_factor(node->right) <= 0)
-        return rotate_left(node);
-    if (bf < -1 && avl_balance_factor(node->right) > 0) {
-        node->right = rotate_right(node->right);
-        return rotate_left(node);
+    return visited;
+}
+
+/* ============================================================================
+ * Bulk Build
+ * ============================================================================
+ */
+
+/* Shared, read-only state for one bulk build */
+typedef struct {
+    const int* keys;
+    NodePool* pool;
+    AVLNode** slots;    /* Nodes carved in preorder, or NULL */
+    int sized;          /* Mode of the nodes built */
+} AVLBuild;
+
+typedef struct {
+    const AVLBuild* build;
+    int lo, hi;
+    int pre;            /* Preorder index of this subtree's root */
+    int spawn;          /* Fork-join levels still allowed */
+    AVLNode* out;
+} AVLBuildTask;
+
+static AVLNode* avl_build_range(const AVLBuild* b, int lo, int hi, int pre, int spawn);
+
+static void avl_build_task(void* arg) {
+    AVLBuildTask* t = arg;
+    t->out = avl_build_range(t->build, t->lo, t->hi, t->pre, t->spawn);
+}
+
+/* Middle key becomes the root, so sibling subtrees differ in size by at
+ * most one and no rotations are needed; heights come back up with the
+ * recursion. Nodes are allocated in preorder. Near the top the disjoint
+ * halves are built on separate threads. A non-empty range only comes back
+ * NULL when memory ran out; whatever was built below is released again. */
+static AVLNode* avl_build_range(const AVLBuild* b, int lo, int hi, int pre, int spawn) {
+    if (lo > hi) return NULL;
+
+    int mid = lo + (hi - lo) / 2;
+    AVLNode* node = b->slots ? b->slots[pre] : avl_node_alloc(b->pool);
+    if (!node) return NULL;
+    node->key = b->keys[mid];
+    node->dead = 0;
+    node->count = 1;
+    node->sized = b->sized;
+
+    int left_pre = pre + 1;
+    int right_pre = pre + 1 + (mid - lo);
+    if (spawn > 0 && hi - lo >= PAR_GRAIN) {
+        AVLBuildTask left = { b, lo, mid - 1, left_pre, spawn - 1, NULL };
+        AVLBuildTask right = { b, mid + 1, hi, right_pre, spawn - 1, NULL };
+        par_invoke(avl_build_task, &left, avl_build_task, &right);
+        node->left = left.out;
+        node->right = right.out;
+    } else {
+        node->left = avl_build_range(b, lo, mid - 1, left_pre, 0);
+        node->right = avl_build_range(b, mid + 1, hi, right_pre, 0);
     }
 
+    if ((lo < mid && !node->left) || (mid < hi && !node->right)) {
+        avl_free_in(b->pool, node->left);
+        avl_free_in(b->pool, node->right);
+        avl_node_release(b->pool, node);
+        return NULL;
+    }
+    avl_update(node);
     return node;
 }
 
-AVLNode* avl_search(AVLNode* node, int key) {
+/* Build sorted, distinct keys. The pool is single-threaded: a parallel
+ * pooled build carves every node up front, in preorder, and the threads
+ * fill their own disjoint slots. NULL if memory runs out. */
+static AVLNode* avl_build_from(NodePool* pool, int sized, const int* keys, int n,
+                               int spawn) {
+    AVLBuild build = { keys, pool, NULL, sized };
+    if (pool && spawn > 0) {
+        build.slots = malloc(sizeof(AVLNode*) * (size_t)n);
+        if (!build.slots) return NULL;
+        for (int i = 0; i < n; i++) {
+            build.slots[i] = avl_node_alloc(pool);
+            if (!build.slots[i]) {
+                while (i-- > 0) avl_node_release(pool, build.slots[i]);
+                free(build.slots);
+                return NULL;
+            }
+        }
+    }
+
+    AVLNode* root = avl_build_range(&build, 0, n - 1, 0, spawn);
+    free(build.slots);
+    return root;
+}
+
+static int avl_is_ascending(const int* keys, int n) {
+    for (int i = 1; i < n; i++)
+        if (keys[i] <= keys[i - 1]) return 0;
+    return 1;
+}
+
+AVLNode* avl_build_sorted(const int* keys, int n) {
+    if (!keys || n <= 0 || !avl_is_ascending(keys, n)) return NULL;
+    return avl_build_from(NULL, 1, keys, n, 0);
+}
+
+/* Unsorted input: parallel radix sort + dedupe, then parallel build */
+static AVLNode* avl_bulk_load_in(NodePool* pool, int sized, const int* keys, int n,
+                                 int threads) {
+    int* sorted;
+    int unique = bulk_sort_unique(keys, n, threads, &sorted);
+    if (unique <= 0) {
+        free(sorted);
+        return NULL;
+    }
+
+    AVLNode* root = avl_build_from(pool, sized, sorted, unique,
+                                   par_spawn_depth(par_threads(threads)));
+    free(sorted);
+    return root;
+}
+
+AVLNode* avl_bulk_load(const int* keys, int n, int threads) {
+    return avl_bulk_load_in(NULL, 1, keys, n, threads);
+}
+
+/* ============================================================================
+ * Tree Handle
+ * ============================================================================
+ */
+
+AVLTree* avl_create(void) {
+    AVLTree* tree = malloc(sizeof(AVLTree));
+    if (!tree) return NULL;
+    tree->root = NULL;
+    tree->pool = NULL;
+    tree->tombstones = 0;
+    tree->tombstone_limit = 0.0;
+    tree->bloom = NULL;
+    tree->multiset = 0;
+    tree->sized = 0;
+    tree->nodes = 0;
+    return tree;
+}
+
+AVLTree* avl_create_pooled(size_t nodes_per_slab) {
+    AVLTree* tree = avl_create();
+    if (!tree) return NULL;
+    tree->pool = pool_create(sizeof(AVLNode), nodes_per_slab);
+    if (!tree->pool) {
+        free(tree);
+        return NULL;
+    }
+    return tree;
+}
+
+/* Pooled trees drop whole slabs instead of walking every node */
+void avl_destroy(AVLTree* tree) {
+    if (!tree) return;
+    if (tree->pool) pool_destroy(tree->pool);
+    else avl_free(tree->root);
+    bloom_destroy(tree->bloom);
+    free(tree);
+}
+
+/* Refill the filter from the live keys, sized with headroom to grow */
+static void avl_bloom_rebuild(AVLTree* tree) {
+    int live = tree->nodes - tree->tombstones;
+    if (!bloom_reset(tree->bloom, (size_t)live + (size_t)live / 2)) return;
+
+    AVLCursor c;
+    avl_cursor_init(&c, tree->root);
+    for (AVLNode* node = avl_cursor_first(&c); node; node = avl_cursor_next(&c))
+        bloom_add(tree->bloom, node->key);
+}
+
+static void avl_bloom_check(AVLTree* tree) {
+    if (tree->bloom && bloom_stale(tree->bloom)) avl_bloom_rebuild(tree);
+}
+
+/* Attach a blocked Bloom filter built from the current keys; later inserts
+ * and deletes keep it current. Returns 1 on success. */
+int avl_tree_enable_bloom(AVLTree* tree, int bits_per_key) {
+    if (!tree) return 0;
+    if (!tree->bloom) {
+        tree->bloom = bloom_create(0, bits_per_key);
+        if (!tree->bloom) return 0;
+    }
+    avl_bloom_rebuild(tree);
+    return 1;
+}
+
+/* avl_search behind the filter: most misses cost one cache-line probe */
+AVLNode* avl_tree_search(AVLTree* tree, int key) {
+    if (!tree) return NULL;
+    if (tree->bloom && !bloom_may_contain(tree->bloom, key)) return NULL;
+    return avl_search(tree->root, key);
+}
+
+/* A tombstone set (delta -1) or cleared (+1) on the node holding key moves
+ * the live size of every node from the root down to it */
+static void avl_resize_path(AVLNode* node, int key, int delta) {
+    while (node) {
+        node->size += delta;
+        if (key == node->key) break;
+        node = key < node->key ? node->left : node->right;
+    }
+}
+
+/* Inserting a key that is a tombstone revives the node in place. A key
+ * that was already live gains a copy in multiset mode; either way the
+ * filter already holds it. */
+AVLNode* avl_tree_insert(AVLTree* tree, int key) {
+    if (!tree) return NULL;
+
+    int created;
+    AVLNode* node = avl_insert_in(tree->pool, &tree->root, key, tree->sized, &created);
     if (!node) return NULL;
-    if (key == node->key) return node;
-    if (key < node->key) return avl_search(node->left, key);
-    return avl_search(node->right, key);
+    if (created) {
+        tree->nodes++;
+    } else if (node->dead) {
+        node->dead = 0;
+        node->count = 1;
+        tree->tombstones--;
+        if (tree->sized) avl_resize_path(tree->root, key, 1);
+    } else {
+        if (!tree->multiset) return node;
+        if (node->count == AVL_MAX_COUNT) return NULL;
+        node->count++;
+        return node;
+    }
+    if (tree->bloom) {
+        bloom_add(tree->bloom, key);
+        avl_bloom_check(tree);
+    }
+    return node;
 }
 
-void avl_free(AVLNode* node) {
-    if (!node) return;
-    avl_free(node->left);
-    avl_free(node->right);
-    free(node);
+/* Returns 1 if key was live. In lazy mode the node only becomes a
+ * tombstone: no rotations, and a sized tree takes it out of the sizes on
+ * the path. */
+int avl_tree_delete(AVLTree* tree, int key) {
+    if (!tree) return 0;
+
+    AVLNode* node = avl_find(tree->root, key);
+    if (!node) return 0;
+
+    int live = !node->dead;
+    if (live && tree->multiset && node->count > 1) {
+        node->count--;
+        return 1;
+    }
+    if (tree->tombstone_limit > 0.0) {
+        if (!live) return 0;
+        node->dead = 1;
+        tree->tombstones++;
+        if (tree->sized) avl_resize_path(tree->root, key, -1);
+        bloom_remove(tree->bloom, 1);
+        if (tree->tombstones > tree->tombstone_limit * tree->nodes)
+            avl_tree_compact(tree);
+        else
+            avl_bloom_check(tree);
+        return 1;
+    }
+
+    if (!live) tree->tombstones--;
+    avl_delete_in(tree->pool, &tree->root, key);
+    tree->nodes--;
+    if (live && tree->bloom) {
+        bloom_remove(tree->bloom, 1);
+        avl_bloom_check(tree);
+    }
+    return live;
+}
+
+/* Tombstones in [lo, hi], visiting only the nodes in range */
+static int avl_count_dead(AVLNode* node, int lo, int hi) {
+    int dead = 0;
+    while (node) {
+        if (node->key < lo) {
+            node = node->right;
+        } else if (node->key > hi) {
+            node = node->left;
+        } else {
+            dead += node->dead + avl_count_dead(node->left, lo, hi);
+            node = node->right;
+        }
+    }
+    return dead;
+}
+
+/* Returns the keys inserted or deleted, -1 if the batch is rejected.
+ * Tombstones the batch touches are revived or removed for real. */
+int avl_tree_apply(AVLTree* tree, const AVLBatchOp* ops, int m, int threads) {
+    if (!tree) return -1;
+
+    int cleared, linked;
+    int changed = avl_apply_in(tree->pool, tree->sized, &tree->root, ops, m, threads,
+                               &cleared, &linked);
+    tree->tombstones -= cleared;
+    tree->nodes += linked;
+
+    /* Deletes are counted as stale whether or not the key was present */
+    if (changed > 0 && tree->bloom) {
+        for (int i = 0; i < m; i++) {
+            if (ops[i].kind == AVL_BATCH_INSERT) bloom_add(tree->bloom, ops[i].key);
+            else bloom_remove(tree->bloom, 1);
+        }
+        avl_bloom_check(tree);
+    }
+    return changed;
+}
+
+/* Returns the number of live keys removed */
+int avl_tree_delete_range(AVLTree* tree, int lo, int hi) {
+    if (!tree) return 0;
+
+    int dead = tree->tombstones ? avl_count_dead(tree->root, lo, hi) : 0;
+    tree->tombstones -= dead;
+    int removed = avl_delete_range_in(tree->pool, &tree->root, lo, hi);
+    tree->nodes -= removed + dead;
+    if (removed > 0 && tree->bloom) {
+        bloom_remove(tree->bloom, (size_t)removed);
+        avl_bloom_check(tree);
+    }
+    return removed;
+}
+
+/* Fill an empty tree from strictly ascending keys in O(n), taking the
+ * nodes from its pool in preorder. Returns 1 on success, 0 if the tree is
+ * not empty, the keys are unsorted or memory runs out (the tree is then
+ * still empty). */
+int avl_tree_build_sorted(AVLTree* tree, const int* keys, int n) {
+    if (!tree || tree->root || n < 0 || (n > 0 && !keys)) return 0;
+    if (!avl_is_ascending(keys, n)) return 0;
+    if (n == 0) return 1;
+
+    tree->root = avl_build_from(tree->pool, tree->sized, keys, n, 0);
+    if (!tree->root) return 0;
+    tree->nodes = n;
+    if (tree->bloom) avl_bloom_rebuild(tree);
+    return 1;
+}
+
+/* As above from unsorted keys (duplicates dropped), on `threads` threads */
+int avl_tree_bulk_load(AVLTree* tree, const int* keys, int n, int threads) {
+    if (!tree || tree->root || n < 0 || (n > 0 && !keys)) return 0;
+    if (n == 0) return 1;
+
+    tree->root = avl_bulk_load_in(tree->pool, tree->sized, keys, n, threads);
+    if (!tree->root) return 0;
+    tree->nodes = avl_size(tree->root);
+    if (tree->bloom) avl_bloom_rebuild(tree);
+    return 1;
+}
+
+int avl_set_multiset(AVLTree* tree, int enabled) {
+    if (!tree || tree->root) return 0;
+    tree->multiset = enabled != 0;
+    return 1;
+}
+
+int avl_set_sized(AVLTree* tree, int enabled) {
+    if (!tree || tree->root) return 0;
+    tree->sized = enabled != 0;
+    return 1;
+}
+
+/* Copies of key held by the tree (0 if absent or a tombstone) */
+int avl_tree_count(AVLTree* tree, int key) {
+    if (!tree) return 0;
+    AVLNode* node = avl_search(tree->root, key);
+    return node ? (int)node->count : 0;
+}
+
+/* ============================================================================
+ * Lazy Delete and Compaction
+ *
+ * Compaction threads the tree into an in-order list through ->right
+ * (rotating left children up, as in a stack-free free), releasing
+ * tombstones on the way, then rebuilds a perfectly balanced tree from the
+ * list by counting: O(n) time, no allocation, recursion depth O(log n).
+ * ============================================================================
+ */
+
+/* In-order list of the live nodes through ->right; returns the count */
+static int avl_flatten_live(NodePool* pool, AVLNode* node, AVLNode** head) {
+    AVLNode** tail = head;
+    int n = 0;
+
+    while (node) {
+        if (node->left) {
+            AVLNode* left = node->left;
+            node->left = left->right;
+            left->right = node;
+            node = left;
+        } else {
+            AVLNode* next = node->right;
+            if (node->dead) {
+                avl_node_release(pool, node);
+            } else {
+                *tail = node;
+                tail = &node->right;
+                n++;
+            }
+            node = next;
+        }
+    }
+    *tail = NULL;
+    return n;
+}
+
+/* Build a tree from the first n list nodes, advancing *head past them */
+static AVLNode* avl_build_list(AVLNode** head, int n) {
+    if (n <= 0) return NULL;
+
+    AVLNode* left = avl_build_list(head, n / 2);
+    AVLNode* node = *head;
+    *head = node->right;
+    node->left = left;
+    node->right = avl_build_list(head, n - n / 2 - 1);
+    avl_update(node);
+    return node;
+}
+
+/* limit > 0: deletes leave tombstones until they exceed that fraction of
+ * the nodes, then the tree is compacted. limit <= 0: eager deletes. */
+void avl_set_lazy_delete(AVLTree* tree, double limit) {
+    if (tree) tree->tombstone_limit = limit > 0.0 ? limit : 0.0;
+}
+
+void avl_tree_compact(AVLTree* tree) {
+    if (!tree) return;
+
+    AVLNode* list;
+    int n = avl_flatten_live(tree->pool, tree->root, &list);
+    tree->root = avl_build_list(&list, n);
+    tree->nodes = n;
+    tree->tombstones = 0;
+    if (tree->bloom) avl_bloom_rebuild(tree);
 }
 
 typedef enum {
@@ -0,0 +1,244 @@
+#include <stdlib.h>
+#include <limits.h>
+#include "avl_agg.h"
+#include "avl.h"      /* AVL_MAX_DEPTH */
+
+/* ============================================================================
+ * Aggregate Maintenance
+ *
+ * Same balancing scheme as avl.c (iterative descent recording the path,
+ * bottom-up retrace), but the retrace always runs to the root: a changed
+ * value changes every ancestor's aggregate even when no height changes.
+ * ============================================================================
+ */
+
+int avl_agg_height(AVLAggNode* node) {
+    return node ? node->height : -1;
+}
+
+/* Recompute height and aggregates from the node's own value and children */
+static void agg_update(AVLAggNode* node) {
+    AVLAggNode* l = node->left;
+    AVLAggNode* r = node->right;
+    int hl = avl_agg_height(l);
+    int hr = avl_agg_height(r);
+
+    node->height = 1 + (hl > hr ? hl : hr);
+    node->count = 1;
+    node->sum = node->min = node->max = node->value;
+    if (l) {
+        node->count += l->count;
+        node->sum += l->sum;
+        if (l->min < node->min) node->min = l->min;
+        if (l->max > node->max) node->max = l->max;
+    }
+    if (r) {
+        node->count += r->count;
+        node->sum += r->sum;
+        if (r->min < node->min) node->min = r->min;
+        if (r->max > node->max) node->max = r->max;
+    }
+}
+
+static int agg_balance(AVLAggNode* node) {
+    return avl_agg_height(node->left) - avl_agg_height(node->right);
+}
+
+/* The lower node is refreshed first: it is the child of the new root */
+static AVLAggNode* agg_rotate_right(AVLAggNode* y) {
+    AVLAggNode* x = y->left;
+    y->left = x->right;
+    x->right = y;
+    agg_update(y);
+    agg_update(x);
+    return x;
+}
+
+static AVLAggNode* agg_rotate_left(AVLAggNode* x) {
+    AVLAggNode* y = x->right;
+    x->right = y->left;
+    y->left = x;
+    agg_update(x);
+    agg_update(y);
+    return y;
+}
+
+static AVLAggNode* agg_rebalance(AVLAggNode* node) {
+    int bf = agg_balance(node);
+
+    if (bf > 1) {
+        // LR
+        if (agg_balance(node->left) < 0)
+            node->left = agg_rotate_left(node->left);
+        // LL
+        return agg_rotate_right(node);
+    }
+    if (bf < -1) {
+        // RL
+        if (agg_balance(node->right) > 0)
+            node->right = agg_rotate_right(node->right);
+        // RR
+        return agg_rotate_left(node);
+    }
+    return node;
+}
+
+static void agg_retrace(AVLAggNode** path[], int depth) {
+    while (depth > 0) {
+        AVLAggNode** link = path[--depth];
+        agg_update(*link);
+        *link = agg_rebalance(*link);
+    }
+}
+
+/* ============================================================================
+ * Insert / Delete
+ * ============================================================================
+ */
+
+static AVLAggNode* agg_put(AVLAggNode** root, int key, long long value, int add) {
+    AVLAggNode** path[AVL_MAX_DEPTH];
+    int depth = 0;
+    AVLAggNode** link = root;
+
+    while (*link && (*link)->key != key) {
+        path[depth++] = link;
+        link = key < (*link)->key ? &(*link)->left : &(*link)->right;
+    }
+
+    AVLAggNode* node = *link;
+    if (node) {
+        node->value = add ? node->value + value : value;
+        agg_update(node);
+    } else {
+        node = malloc(sizeof(AVLAggNode));
+        if (!node) return NULL;
+        node->key = key;
+        node->value = value;
+        node->left = node->right = NULL;
+        agg_update(node);
+        *link = node;
+    }
+
+    agg_retrace(path, depth);
+    return node;
+}
+
+AVLAggNode* avl_agg_insert(AVLAggNode* root, int key, long long value) {
+    agg_put(&root, key, value, 0);
+    return root;
+}
+
+AVLAggNode* avl_agg_add(AVLAggNode* root, int key, long long delta) {
+    agg_put(&root, key, delta, 1);
+    return root;
+}
+
+/* A node with two children takes its successor's key and value; the
+ * successor is unlinked in the same descent */
+AVLAggNode* avl_agg_delete(AVLAggNode* root, int key) {
+    AVLAggNode** path[AVL_MAX_DEPTH];
+    int depth = 0;
+    AVLAggNode** link = &root;
+
+    while (*link && (*link)->key != key) {
+        path[depth++] = link;
+        link = key < (*link)->key ? &(*link)->left : &(*link)->right;
+    }
+
+    AVLAggNode* node = *link;
+    if (!node) return root;
+
+    if (!node->left || !node->right) {
+        *link = node->left ? node->left : node->right;
+    } else {
+        path[depth++] = link;
+        AVLAggNode** succ_link = &node->right;
+        while ((*succ_link)->left) {
+            path[depth++] = succ_link;
+            succ_link = &(*succ_link)->left;
+        }
+
+        AVLAggNode* succ = *succ_link;
+        *succ_link = succ->right;
+        node->key = succ->key;
+        node->value = succ->value;
+        node = succ;
+    }
+
+    free(node);
+    agg_retrace(path, depth);
+    return root;
+}
+
+AVLAggNode* avl_agg_search(AVLAggNode* node, int key) {
+    while (node && node->key != key)
+        node = key < node->key ? node->left : node->right;
+    return node;
+}
+
+void avl_agg_free(AVLAggNode* node) {
+    if (!node) return;
+    avl_agg_free(node->left);
+    avl_agg_free(node->right);
+    free(node);
+}
+
+/* ============================================================================
+ * Range Aggregate
+ *
+ * Below the node where the search paths for lo and hi part, each boundary
+ * path adds whole subtrees that lie inside the range plus the boundary
+ * nodes themselves: O(log n) cached aggregates in total.
+ * ============================================================================
+ */
+
+static void agg_add_value(AVLAggregate* acc, long long value) {
+    acc->count++;
+    acc->sum += value;
+    if (value < acc->min) acc->min = value;
+    if (value > acc->max) acc->max = value;
+}
+
+static void agg_add_subtree(AVLAggregate* acc, AVLAggNode* node) {
+    if (!node) return;
+    acc->count += node->count;
+    acc->sum += node->sum;
+    if (node->min < acc->min) acc->min = node->min;
+    if (node->max > acc->max) acc->max = node->max;
+}
+
+AVLAggregate avl_agg_range(AVLAggNode* root, int lo, int hi) {
+    AVLAggregate acc = { 0, 0, LLONG_MAX, LLONG_MIN };
+    if (lo > hi) return acc;
+
+    /* Descend to the split node: the first one inside [lo, hi] */
+    AVLAggNode* node = root;
+    while (node && (node->key < lo || node->key > hi))
+        node = node->key < lo ? node->right : node->left;
+    if (!node) return acc;
+    agg_add_value(&acc, node->value);
+
+    /* Left boundary: keys >= lo; right subtrees of nodes in range are whole */
+    for (AVLAggNode* n = node->left; n; ) {
+        if (n->key >= lo) {
+            agg_add_value(&acc, n->value);
+            agg_add_subtree(&acc, n->right);
+            n = n->left;
+        } else {
+            n = n->right;
+        }
+    }
+
+    /* Right boundary: mirror image for keys <= hi */
+    for (AVLAggNode* n = node->right; n; ) {
+        if (n->key <= hi) {
+            agg_add_value(&acc, n->value);
+            agg_add_subtree(&acc, n->left);
+            n = n->right;
+        } else {
+            n = n->left;
+        }
+    }
+    return acc;
+}
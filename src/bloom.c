@@ -0,0 +1,135 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "bloom.h"
+
+#if defined(_WIN32)
+#include <malloc.h>
+#define bloom_aligned_alloc(size) _aligned_malloc((size), BLOOM_BLOCK_BYTES)
+#define bloom_aligned_free(ptr)   _aligned_free(ptr)
+#else
+#define bloom_aligned_alloc(size) aligned_alloc(BLOOM_BLOCK_BYTES, (size))
+#define bloom_aligned_free(ptr)   free(ptr)
+#endif
+
+/* ============================================================================
+ * Blocked Bloom Filter Implementation
+ *
+ * One 64-bit mix of the key picks the block (high half, by multiply-shift)
+ * and seeds k bit positions inside its 512 bits (low half, by double
+ * hashing).
+ * ============================================================================
+ */
+
+#define BLOOM_BLOCK_BITS   (BLOOM_BLOCK_BYTES * 8)
+#define BLOOM_BLOCK_WORDS  (BLOOM_BLOCK_BYTES / 8)
+
+struct BloomFilter {
+    uint64_t *blocks;
+    size_t block_count;
+    size_t capacity;         /* Keys the current size was chosen for */
+    size_t added;            /* Keys added since the last reset */
+    size_t removed;          /* Deletes since the last reset */
+    int bits_per_key;
+    int hashes;              /* k */
+};
+
+/* 64-bit finalizer (splitmix64) */
+static uint64_t bloom_hash(int key) {
+    uint64_t h = (uint64_t)(uint32_t)key + 0x9E3779B97F4A7C15ULL;
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+    return h ^ (h >> 31);
+}
+
+static uint64_t* bloom_block(const BloomFilter *filter, uint64_t h) {
+    size_t index = (size_t)(((h >> 32) * (uint64_t)filter->block_count) >> 32);
+    return filter->blocks + index * BLOOM_BLOCK_WORDS;
+}
+
+BloomFilter* bloom_create(size_t capacity, int bits_per_key) {
+    BloomFilter *filter = (BloomFilter *)malloc(sizeof(BloomFilter));
+    if (!filter) return NULL;
+
+    filter->blocks = NULL;
+    filter->block_count = 0;
+    filter->bits_per_key = bits_per_key > 0 ? bits_per_key : BLOOM_DEFAULT_BITS;
+
+    /* k = bits per key * ln 2 minimises false positives */
+    filter->hashes = filter->bits_per_key * 69 / 100;
+    if (filter->hashes < 1) filter->hashes = 1;
+    if (filter->hashes > 16) filter->hashes = 16;
+
+    if (!bloom_reset(filter, capacity)) {
+        free(filter);
+        return NULL;
+    }
+    return filter;
+}
+
+void bloom_destroy(BloomFilter *filter) {
+    if (!filter) return;
+    bloom_aligned_free(filter->blocks);
+    free(filter);
+}
+
+int bloom_reset(BloomFilter *filter, size_t capacity) {
+    if (!filter) return 0;
+
+    size_t bits = capacity * (size_t)filter->bits_per_key;
+    size_t count = (bits + BLOOM_BLOCK_BITS - 1) / BLOOM_BLOCK_BITS;
+    if (count == 0) count = 1;
+
+    if (count != filter->block_count) {
+        uint64_t *blocks = (uint64_t *)bloom_aligned_alloc(count * BLOOM_BLOCK_BYTES);
+        if (!blocks) return 0;
+        bloom_aligned_free(filter->blocks);
+        filter->blocks = blocks;
+        filter->block_count = count;
+    }
+    memset(filter->blocks, 0, filter->block_count * BLOOM_BLOCK_BYTES);
+    filter->capacity = capacity;
+    filter->added = 0;
+    filter->removed = 0;
+    return 1;
+}
+
+void bloom_add(BloomFilter *filter, int key) {
+    if (!filter) return;
+
+    uint64_t h = bloom_hash(key);
+    uint64_t *block = bloom_block(filter, h);
+    uint32_t a = (uint32_t)h;
+    uint32_t step = (a >> 16) | 1;
+    for (int i = 0; i < filter->hashes; i++) {
+        uint32_t bit = (a + (uint32_t)i * step) % BLOOM_BLOCK_BITS;
+        block[bit / 64] |= (uint64_t)1 << (bit % 64);
+    }
+    filter->added++;
+}
+
+void bloom_remove(BloomFilter *filter, size_t count) {
+    if (filter) filter->removed += count;
+}
+
+int bloom_may_contain(const BloomFilter *filter, int key) {
+    if (!filter) return 1;
+
+    uint64_t h = bloom_hash(key);
+    const uint64_t *block = bloom_block(filter, h);
+    uint32_t a = (uint32_t)h;
+    uint32_t step = (a >> 16) | 1;
+    for (int i = 0; i < filter->hashes; i++) {
+        uint32_t bit = (a + (uint32_t)i * step) % BLOOM_BLOCK_BITS;
+        if (!(block[bit / 64] & ((uint64_t)1 << (bit % 64)))) return 0;
+    }
+    return 1;
+}
+
+/* Worth rebuilding: more keys than it was sized for, or over a quarter of
+ * its entries belong to deleted keys */
+int bloom_stale(const BloomFilter *filter) {
+    if (!filter) return 0;
+    if (filter->added > 2 * filter->capacity + 64) return 1;
+    return filter->removed > 64 && filter->removed * 4 > filter->added;
+}
@@ -1,57 +1,153 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "bst.h"
+#include "bulk.h"
+#include "parallel.h"
+#include "prefetch.h"
 
-BSTNode* bst_insert(BSTNode* root, int key) {
-    if (!root) {
-        BSTNode* node = malloc(sizeof(BSTNode));
-        node->key = key;
-        node->left = node->right = NULL;
-        return node;
+/* Node storage: from the tree's pool when it has one, else the heap */
+static BSTNode* bst_node_alloc(NodePool* pool) {
+    return pool ? pool_alloc(pool) : malloc(sizeof(BSTNode));
+}
+
+static void bst_node_release(NodePool* pool, BSTNode* node) {
+    if (pool) pool_free(pool, node);
+    else free(node);
+}
+
+/* Morris walk (see bst_inorder): no stack at any depth */
+static int bst_count_nodes(BSTNode* root) {
+    int n = 0;
+    BSTNode* cur = root;
+    while (cur) {
+        if (!cur->left) {
+            n++;
+            cur = cur->right;
+            continue;
+        }
+
+        BSTNode* pred = cur->left;
+        while (pred->right && pred->right != cur)
+            pred = pred->right;
+
+        if (!pred->right) {
+            pred->right = cur;
+            cur = cur->left;
+        } else {
+            pred->right = NULL;
+            n++;
+            cur = cur->right;
+        }
     }
+    return n;
+}
 
-    if (key < root->key)
-        root->left = bst_insert(root->left, key);
-    else if (key > root->key)
-        root->right = bst_insert(root->right, key);
+/* Stored in sized nodes, counted otherwise */
+int bst_size(BSTNode* node) {
+    if (!node) return 0;
+    return node->sized ? node->size : bst_count_nodes(node);
+}
 
-    return root; // ignore duplicates
+/* Add delta to the size of every node above the one holding key */
+static void bst_resize_path(BSTNode* node, int key, int delta) {
+    while (node && node->key != key) {
+        node->size += delta;
+        node = key < node->key ? node->left : node->right;
+    }
 }
 
-BSTNode* bst_delete(BSTNode* root, int key) {
-    if (!root) return NULL;
+/* Pointer-to-pointer descent: `link` always addresses the slot that will
+ * hold the node, so there is no recursion and no parent bookkeeping. Deep
+ * (degenerate) trees cost no stack. In a sized tree, sizes are bumped by a
+ * second walk once the key is known to be new. The depth of a new node is
+ * stored in *depth (left alone for an existing key). */
+static BSTNode* bst_insert_in(NodePool* pool, BSTNode** root, int key, int sized,
+                              int* depth) {
+    BSTNode** link = root;
+    int d = 0;
+    while (*link) {
+        BSTNode* cur = *link;
+        if (key < cur->key)
+            link = &cur->left;
+        else if (key > cur->key)
+            link = &cur->right;
+        else
+            return cur; // ignore duplicates
+        d++;
+    }
+    if (depth) *depth = d;
 
-    if (key < root->key)
-        root->left = bst_delete(root->left, key);
-    else if (key > root->key)
-        root->right = bst_delete(root->right, key);
-    else {
-        if (!root->left) {
-            BSTNode* temp = root->right;
-            free(root);
-            return temp;
-        }
-        if (!root->right) {
-            BSTNode* temp = root->left;
-            free(root);
-            return temp;
+    BSTNode* node = bst_node_alloc(pool);
+    if (!node) return NULL;
+    node->key = key;
+    node->size = 1;
+    node->count = 1;
+    node->sized = sized;
+    node->left = node->right = NULL;
+    if (sized) bst_resize_path(*root, key, 1);
+    *link = node;
+    return node;
+}
+
+/* multiset: a node holding several copies only loses one. *unlinked tells
+ * whether a node left the tree. */
+static int bst_delete_in(NodePool* pool, BSTNode** root, int key, int multiset,
+                         int* unlinked) {
+    BSTNode** link = root;
+    while (*link && (*link)->key != key)
+        link = key < (*link)->key ? &(*link)->left : &(*link)->right;
+
+    *unlinked = 0;
+    BSTNode* node = *link;
+    if (!node) return 0;
+    if (multiset && node->count > 1) {
+        node->count--;
+        return 1;
+    }
+    int sized = node->sized;
+    if (sized) bst_resize_path(*root, key, -1);
+
+    if (!node->left) {
+        *link = node->right;
+    } else if (!node->right) {
+        *link = node->left;
+    } else {
+        /* Two children: unlink the successor in the same descent */
+        BSTNode** succ_link = &node->right;
+        if (sized) node->size--;
+        while ((*succ_link)->left) {
+            if (sized) (*succ_link)->size--;
+            succ_link = &(*succ_link)->left;
         }
 
-        BSTNode* succ = bst_min(root->right);
-        root->key = succ->key;
-        root->right = bst_delete(root->right, succ->key);
+        BSTNode* succ = *succ_link;
+        *succ_link = succ->right;
+        node->key = succ->key;
+        node->count = succ->count;
+        node = succ;
     }
+
+    bst_node_release(pool, node);
+    *unlinked = 1;
+    return 1;
+}
+
+BSTNode* bst_insert(BSTNode* root, int key) {
+    int depth;
+    bst_insert_in(NULL, &root, key, root ? root->sized : 1, &depth);
     return root;
 }
 
-BSTNode* bst_search(BSTNode* root, int key) {
-    if (!root || root->key == key)
-        return root;
+BSTNode* bst_delete(BSTNode* root, int key) {
+    int unlinked;
+    bst_delete_in(NULL, &root, key, 0, &unlinked);
+    return root;
+}
 
-    if (key < root->key)
-        return bst_search(root->left, key);
-    else
-        return bst_search(root->right, key);
+BSTNode* bst_search(BSTNode* root, int key) {
+    while (root && root->key != key)
+        root = key < root->key ? root->left : root->right;
+    return root;
 }
 
 BSTNode* bst_min(BSTNode* root) {
@@ -61,16 +157,781 @@ BSTNode* bst_min(BSTNode* root) {
     return root;
 }
 
+/* Morris traversal: threads temporary links through right pointers and
+ * removes them again, so the walk needs no stack at any depth */
 void bst_inorder(BSTNode* root, int* arr, int* index) {
-    if (!root) return;
-    bst_inorder(root->left, arr, index);
-    arr[(*index)++] = root->key;
-    bst_inorder(root->right, arr, index);
+    BSTNode* cur = root;
+    while (cur) {
+        if (!cur->left) {
+            arr[(*index)++] = cur->key;
+            cur = cur->right;
+            continue;
+        }
+
+        BSTNode* pred = cur->left;
+        while (pred->right && pred->right != cur)
+            pred = pred->right;
+
+        if (!pred->right) {
+            pred->right = cur;
+            cur = cur->left;
+        } else {
+            pred->right = NULL;
+            arr[(*index)++] = cur->key;
+            cur = cur->right;
+        }
+    }
+}
+
+/* Rotate left children up until the root has none, then free it and move
+ * right; O(n) time, O(1) space */
+static void bst_free_in(NodePool* pool, BSTNode* root) {
+    while (root) {
+        if (root->left) {
+            BSTNode* left = root->left;
+            root->left = left->right;
+            left->right = root;
+            root = left;
+        } else {
+            BSTNode* right = root->right;
+            bst_node_release(pool, root);
+            root = right;
+        }
+    }
 }
 
 void bst_free(BSTNode* root) {
-    if (!root) return;
-    bst_free(root->left);
-    bst_free(root->right);
-    free(root);
+    bst_free_in(NULL, root);
+}
+
+/* ============================================================================
+ * Rebalancing (Day-Stout-Warren)
+ *
+ * Right rotations straighten the tree into a sorted right "vine", then
+ * rounds of left rotations along the vine fold it into a tree that is
+ * complete except for the bottom level. A stack dummy above the root lets
+ * every rotation go through a link, so the whole pass is O(n) time and
+ * O(1) extra memory. Sizes, if kept, are carried by each rotation.
+ * ============================================================================
+ */
+
+/* Rotate the subtree at *link right (left child comes up) */
+static void bst_rotate_right_at(BSTNode** link) {
+    BSTNode* x = *link;
+    BSTNode* y = x->left;
+    x->left = y->right;
+    y->right = x;
+    if (x->sized) {
+        y->size = x->size;
+        x->size = 1 + bst_size(x->left) + bst_size(x->right);
+    }
+    *link = y;
+}
+
+static void bst_rotate_left_at(BSTNode** link) {
+    BSTNode* x = *link;
+    BSTNode* y = x->right;
+    x->right = y->left;
+    y->left = x;
+    if (x->sized) {
+        y->size = x->size;
+        x->size = 1 + bst_size(x->left) + bst_size(x->right);
+    }
+    *link = y;
+}
+
+/* Left-rotate every other node of the top `count` pairs on the vine */
+static void bst_compress(BSTNode* dummy, int count) {
+    BSTNode* scan = dummy;
+    for (int i = 0; i < count; i++) {
+        bst_rotate_left_at(&scan->right);
+        scan = scan->right;
+    }
+}
+
+BSTNode* bst_rebalance(BSTNode* root) {
+    BSTNode dummy;
+    dummy.right = root;
+    dummy.left = NULL;
+
+    /* Tree to vine, counting the nodes */
+    BSTNode* tail = &dummy;
+    int n = 0;
+    while (tail->right) {
+        if (tail->right->left) {
+            bst_rotate_right_at(&tail->right);
+        } else {
+            tail = tail->right;
+            n++;
+        }
+    }
+
+    /* Vine to tree: first fold away the nodes of the partial bottom level */
+    int full = 1;
+    while (2 * full + 1 <= n)
+        full = 2 * full + 1;            /* largest 2^k - 1 <= n */
+    bst_compress(&dummy, n - full);
+    for (int m = full / 2; m > 0; m /= 2)
+        bst_compress(&dummy, m);
+
+    return dummy.right;
+}
+
+/* ceil(log2(n + 1)): levels of a minimum-height tree with n nodes */
+static int bst_min_levels(int n) {
+    int levels = 0;
+    while (n > 0) {
+        levels++;
+        n >>= 1;
+    }
+    return levels;
+}
+
+/* ============================================================================
+ * Range Queries
+ * ============================================================================
+ */
+
+/* Keys below key (or up to key when inclusive), summing left sizes */
+static int bst_count_below(BSTNode* node, int key, int inclusive) {
+    int count = 0;
+    while (node) {
+        if (key < node->key || (key == node->key && !inclusive)) {
+            node = node->left;
+        } else {
+            count += bst_size(node->left) + 1;
+            node = node->right;
+        }
+    }
+    return count;
+}
+
+static int bst_count_one(BSTNode* node, void* arg) {
+    (void)node;
+    (void)arg;
+    return 1;
+}
+
+/* Without sizes the range is walked instead: O(h + k) */
+int bst_range_count(BSTNode* root, int lo, int hi) {
+    if (lo > hi) return 0;
+    if (root && !root->sized) return bst_visit_range(root, lo, hi, bst_count_one, NULL);
+    return bst_count_below(root, hi, 1) - bst_count_below(root, lo, 0);
+}
+
+/* Sizes along a right (or left) spine whose side subtrees are final:
+ * each size is the sum over the rest of the spine (if sizes are kept) */
+static void bst_resize_spine(BSTNode* node, int right) {
+    if (!node || !node->sized) return;
+    int total = 0;
+    for (BSTNode* n = node; n; n = right ? n->right : n->left)
+        total += 1 + bst_size(right ? n->left : n->right);
+    for (BSTNode* n = node; n; n = right ? n->right : n->left) {
+        n->size = total;
+        total -= 1 + bst_size(right ? n->left : n->right);
+    }
+}
+
+/* Keep the keys < lo of a subtree whose keys are all <= hi. The kept nodes
+ * end up chained along the right spine; every other node is freed. */
+static BSTNode* bst_keep_below(NodePool* pool, BSTNode* node, int lo) {
+    BSTNode** link = &node;
+    while (*link) {
+        BSTNode* cur = *link;
+        if (cur->key >= lo) {
+            *link = cur->left;
+            cur->left = NULL;
+            bst_free_in(pool, cur);
+        } else {
+            link = &cur->right;
+        }
+    }
+    bst_resize_spine(node, 1);
+    return node;
+}
+
+/* Mirror of bst_keep_below: keep the keys > hi of a subtree above lo */
+static BSTNode* bst_keep_above(NodePool* pool, BSTNode* node, int hi) {
+    BSTNode** link = &node;
+    while (*link) {
+        BSTNode* cur = *link;
+        if (cur->key <= hi) {
+            *link = cur->right;
+            cur->right = NULL;
+            bst_free_in(pool, cur);
+        } else {
+            link = &cur->left;
+        }
+    }
+    bst_resize_spine(node, 0);
+    return node;
+}
+
+/* Walk down to the first node inside [lo, hi] (the top of the range), trim
+ * its two subtrees to the keys outside the range, and hang what is left of
+ * the right side under the maximum of the left side. O(h + k). */
+static int bst_delete_range_in(NodePool* pool, BSTNode** root, int lo, int hi) {
+    int k = bst_range_count(*root, lo, hi);
+    if (k == 0) return 0;
+
+    int sized = (*root)->sized;
+    BSTNode** link = root;
+    while ((*link)->key < lo || (*link)->key > hi) {
+        if (sized) (*link)->size -= k;
+        link = (*link)->key < lo ? &(*link)->right : &(*link)->left;
+    }
+
+    BSTNode* top = *link;
+    BSTNode* left = bst_keep_below(pool, top->left, lo);
+    BSTNode* right = bst_keep_above(pool, top->right, hi);
+    bst_node_release(pool, top);
+
+    *link = left;
+    while (*link) {
+        if (sized) (*link)->size += bst_size(right);
+        link = &(*link)->right;
+    }
+    *link = right;
+    return k;
+}
+
+BSTNode* bst_delete_range(BSTNode* root, int lo, int hi) {
+    bst_delete_range_in(NULL, &root, lo, hi);
+    return root;
+}
+
+/* ============================================================================
+ * Sorted Batch Lookup
+ *
+ * Each node splits the remaining query range by binary search: keys below
+ * it go left, keys above go right, and a subtree whose range is empty is
+ * never entered. Descents shared by neighbouring keys happen once, so a
+ * balanced tree answers m sorted keys in O(m log(n/m + 1)), touching nodes
+ * in key order. The pending right halves live on a heap stack, so a
+ * degenerate tree costs no call stack.
+ * ============================================================================
+ */
+
+typedef struct {
+    BSTNode* node;
+    int lo, hi;                 /* Query keys still to resolve below node */
+} BSTLookupTask;
+
+int bst_search_sorted(BSTNode* root, const int* keys, int m, BSTNode** out) {
+    if (m < 0 || (m > 0 && (!keys || !out))) return -1;
+    for (int i = 1; i < m; i++)
+        if (keys[i] < keys[i - 1]) return -1;
+    for (int i = 0; i < m; i++)
+        out[i] = NULL;
+
+    BSTLookupTask* stack = NULL;
+    int depth = 0, capacity = 0, found = 0;
+    BSTNode* node = root;
+    int lo = 0, hi = m - 1;
+
+    for (;;) {
+        while (node && lo <= hi) {
+            /* [lo, first) < node->key, [first, last) == node->key */
+            int first = lo, last, z = hi + 1;
+            while (first < z) {
+                int mid = first + (z - first) / 2;
+                if (keys[mid] < node->key) first = mid + 1;
+                else z = mid;
+            }
+            for (last = first; last <= hi && keys[last] == node->key; last++) {
+                out[last] = node;
+                found++;
+            }
+
+            if (last <= hi && node->right) {
+                if (depth == capacity) {
+                    int grown = capacity ? 2 * capacity : 64;
+                    BSTLookupTask* s = realloc(stack, sizeof(BSTLookupTask) * (size_t)grown);
+                    if (!s) {
+                        free(stack);
+                        return -1;
+                    }
+                    stack = s;
+                    capacity = grown;
+                }
+                stack[depth].node = node->right;
+                stack[depth].lo = last;
+                stack[depth].hi = hi;
+                depth++;
+            }
+            TREE_PREFETCH(node->right);
+            hi = first - 1;
+            node = node->left;
+        }
+
+        if (depth == 0) break;
+        depth--;
+        node = stack[depth].node;
+        lo = stack[depth].lo;
+        hi = stack[depth].hi;
+    }
+
+    free(stack);
+    return found;
+}
+
+/* ============================================================================
+ * Neighbour Queries
+ * ============================================================================
+ */
+
+/* One descent remembering the last node on the wanted side of key: the
+ * closest key below (or above) it, or key itself when inclusive */
+static BSTNode* bst_nearest(BSTNode* node, int key, int below, int inclusive) {
+    BSTNode* best = NULL;
+    while (node) {
+        if (node->key == key && inclusive) return node;
+        if (below ? node->key < key : node->key > key) {
+            best = node;
+            node = below ? node->right : node->left;
+        } else {
+            node = below ? node->left : node->right;
+        }
+    }
+    return best;
+}
+
+BSTNode* bst_floor(BSTNode* root, int key) {
+    return bst_nearest(root, key, 1, 1);
+}
+
+BSTNode* bst_ceil(BSTNode* root, int key) {
+    return bst_nearest(root, key, 0, 1);
+}
+
+BSTNode* bst_predecessor(BSTNode* root, int key) {
+    return bst_nearest(root, key, 1, 0);
+}
+
+BSTNode* bst_successor(BSTNode* root, int key) {
+    return bst_nearest(root, key, 0, 0);
+}
+
+/* ============================================================================
+ * Cursor
+ *
+ * The cursor keeps the whole root-to-node path, so it can step both ways:
+ * forward goes to the leftmost node of the right subtree, or climbs until
+ * it leaves a left subtree (backward mirrors this). Each step prefetches
+ * the subtree the following step will enter.
+ * ============================================================================
+ */
+
+void bst_cursor_init(BSTCursor* c, BSTNode* root) {
+    c->root = root;
+    c->path = NULL;
+    c->depth = 0;
+    c->capacity = 0;
+}
+
+void bst_cursor_release(BSTCursor* c) {
+    free(c->path);
+    c->path = NULL;
+    c->depth = c->capacity = 0;
+}
+
+static BSTNode* bst_cursor_top(const BSTCursor* c) {
+    return c->depth ? c->path[c->depth - 1] : NULL;
+}
+
+static int bst_cursor_push(BSTCursor* c, BSTNode* node) {
+    if (c->depth == c->capacity) {
+        int capacity = c->capacity ? 2 * c->capacity : 32;
+        BSTNode** path = realloc(c->path, sizeof(BSTNode*) * (size_t)capacity);
+        if (!path) return 0;
+        c->path = path;
+        c->capacity = capacity;
+    }
+    c->path[c->depth++] = node;
+    return 1;
+}
+
+/* Push node and its left (or right) spine; the spine end is current */
+static BSTNode* bst_cursor_descend(BSTCursor* c, BSTNode* node, int leftward) {
+    while (node) {
+        if (!bst_cursor_push(c, node)) {
+            c->depth = 0;
+            return NULL;
+        }
+        node = leftward ? node->left : node->right;
+    }
+    node = bst_cursor_top(c);
+    if (node) TREE_PREFETCH(leftward ? node->right : node->left);
+    return node;
+}
+
+BSTNode* bst_cursor_first(BSTCursor* c) {
+    c->depth = 0;
+    return bst_cursor_descend(c, c->root, 1);
+}
+
+BSTNode* bst_cursor_last(BSTCursor* c) {
+    c->depth = 0;
+    return bst_cursor_descend(c, c->root, 0);
+}
+
+BSTNode* bst_cursor_seek(BSTCursor* c, int key) {
+    BSTNode* node = c->root;
+    int keep = 0;   /* Path length up to the best candidate so far */
+
+    c->depth = 0;
+    while (node) {
+        if (!bst_cursor_push(c, node)) break;
+        if (key == node->key) {
+            keep = c->depth;
+            break;
+        }
+        if (key < node->key) {
+            keep = c->depth;
+            node = node->left;
+        } else {
+            node = node->right;
+        }
+    }
+
+    c->depth = keep;
+    node = bst_cursor_top(c);
+    if (node) TREE_PREFETCH(node->right);
+    return node;
+}
+
+/* Step in order (forward) or in reverse */
+static BSTNode* bst_cursor_step(BSTCursor* c, int forward) {
+    BSTNode* node = bst_cursor_top(c);
+    if (!node) return NULL;
+
+    BSTNode* ahead = forward ? node->right : node->left;
+    if (ahead) return bst_cursor_descend(c, ahead, forward);
+
+    /* Climb until we leave a subtree on the side we came from */
+    BSTNode* child;
+    do {
+        child = c->path[--c->depth];
+        node = bst_cursor_top(c);
+    } while (node && (forward ? node->right : node->left) == child);
+
+    if (node) TREE_PREFETCH(forward ? node->right : node->left);
+    return node;
+}
+
+BSTNode* bst_cursor_next(BSTCursor* c) {
+    return bst_cursor_step(c, 1);
+}
+
+BSTNode* bst_cursor_prev(BSTCursor* c) {
+    return bst_cursor_step(c, 0);
+}
+
+int bst_visit_range(BSTNode* root, int lo, int hi, BSTVisitFn fn, void* arg) {
+    BSTCursor c;
+    int visited = 0;
+
+    bst_cursor_init(&c, root);
+    for (BSTNode* node = bst_cursor_seek(&c, lo); node && node->key <= hi;
+         node = bst_cursor_next(&c)) {
+        visited++;
+        if (!fn(node, arg)) break;
+    }
+    bst_cursor_release(&c);
+    return visited;
+}
+
+/* ============================================================================
+ * Bulk Build
+ * ============================================================================
+ */
+
+/* Shared, read-only state for one bulk build */
+typedef struct {
+    const int* keys;
+    NodePool* pool;
+    BSTNode** slots;    /* Nodes carved in preorder, or NULL */
+    int sized;          /* Mode of the nodes built */
+} BSTBuild;
+
+typedef struct {
+    const BSTBuild* build;
+    int lo, hi;
+    int pre;            /* Preorder index of this subtree's root */
+    int spawn;          /* Fork-join levels still allowed */
+    BSTNode* out;
+} BSTBuildTask;
+
+static BSTNode* bst_build_range(const BSTBuild* b, int lo, int hi, int pre, int spawn);
+
+static void bst_build_task(void* arg) {
+    BSTBuildTask* t = arg;
+    t->out = bst_build_range(t->build, t->lo, t->hi, t->pre, t->spawn);
+}
+
+/* Middle key becomes the root; nodes are allocated in preorder so that a
+ * search path walks forward through memory. The two halves are disjoint,
+ * so near the top they are built on separate threads. A non-empty range
+ * only comes back NULL when memory ran out; whatever was built below is
+ * released again. */
+static BSTNode* bst_build_range(const BSTBuild* b, int lo, int hi, int pre, int spawn) {
+    if (lo > hi) return NULL;
+
+    int mid = lo + (hi - lo) / 2;
+    BSTNode* node = b->slots ? b->slots[pre] : bst_node_alloc(b->pool);
+    if (!node) return NULL;
+    node->key = b->keys[mid];
+    node->size = hi - lo + 1;
+    node->count = 1;
+    node->sized = b->sized;
+
+    int left_pre = pre + 1;
+    int right_pre = pre + 1 + (mid - lo);
+    if (spawn > 0 && hi - lo >= PAR_GRAIN) {
+        BSTBuildTask left = { b, lo, mid - 1, left_pre, spawn - 1, NULL };
+        BSTBuildTask right = { b, mid + 1, hi, right_pre, spawn - 1, NULL };
+        par_invoke(bst_build_task, &left, bst_build_task, &right);
+        node->left = left.out;
+        node->right = right.out;
+    } else {
+        node->left = bst_build_range(b, lo, mid - 1, left_pre, 0);
+        node->right = bst_build_range(b, mid + 1, hi, right_pre, 0);
+    }
+
+    if ((lo < mid && !node->left) || (mid < hi && !node->right)) {
+        bst_free_in(b->pool, node->left);
+        bst_free_in(b->pool, node->right);
+        bst_node_release(b->pool, node);
+        return NULL;
+    }
+    return node;
+}
+
+/* Build sorted, distinct keys. The pool is single-threaded: a parallel
+ * pooled build carves every node up front, in preorder, and the threads
+ * fill their own disjoint slots. NULL if memory runs out. */
+static BSTNode* bst_build_from(NodePool* pool, int sized, const int* keys, int n,
+                               int spawn) {
+    BSTBuild build = { keys, pool, NULL, sized };
+    if (pool && spawn > 0) {
+        build.slots = malloc(sizeof(BSTNode*) * (size_t)n);
+        if (!build.slots) return NULL;
+        for (int i = 0; i < n; i++) {
+            build.slots[i] = bst_node_alloc(pool);
+            if (!build.slots[i]) {
+                while (i-- > 0) bst_node_release(pool, build.slots[i]);
+                free(build.slots);
+                return NULL;
+            }
+        }
+    }
+
+    BSTNode* root = bst_build_range(&build, 0, n - 1, 0, spawn);
+    free(build.slots);
+    return root;
+}
+
+static int bst_is_ascending(const int* keys, int n) {
+    for (int i = 1; i < n; i++)
+        if (keys[i] <= keys[i - 1]) return 0;
+    return 1;
+}
+
+BSTNode* bst_build_sorted(const int* keys, int n) {
+    if (!keys || n <= 0 || !bst_is_ascending(keys, n)) return NULL;
+    return bst_build_from(NULL, 1, keys, n, 0);
+}
+
+/* Unsorted input: parallel radix sort + dedupe, then parallel build */
+static BSTNode* bst_bulk_load_in(NodePool* pool, int sized, const int* keys, int n,
+                                 int threads) {
+    int* sorted;
+    int unique = bulk_sort_unique(keys, n, threads, &sorted);
+    if (unique <= 0) {
+        free(sorted);
+        return NULL;
+    }
+
+    BSTNode* root = bst_build_from(pool, sized, sorted, unique,
+                                   par_spawn_depth(par_threads(threads)));
+    free(sorted);
+    return root;
+}
+
+BSTNode* bst_bulk_load(const int* keys, int n, int threads) {
+    return bst_bulk_load_in(NULL, 1, keys, n, threads);
+}
+
+/* ============================================================================
+ * Tree Handle
+ * ============================================================================
+ */
+
+BSTree* bst_create(void) {
+    BSTree* tree = malloc(sizeof(BSTree));
+    if (!tree) return NULL;
+    tree->root = NULL;
+    tree->pool = NULL;
+    tree->rebalance_c = 0.0;
+    tree->rebalances = 0;
+    tree->rebuilt = 0;
+    tree->multiset = 0;
+    tree->sized = 0;
+    tree->nodes = 0;
+    return tree;
+}
+
+BSTree* bst_create_pooled(size_t nodes_per_slab) {
+    BSTree* tree = bst_create();
+    if (!tree) return NULL;
+    tree->pool = pool_create(sizeof(BSTNode), nodes_per_slab);
+    if (!tree->pool) {
+        free(tree);
+        return NULL;
+    }
+    return tree;
+}
+
+/* Pooled trees drop whole slabs instead of walking every node */
+void bst_destroy(BSTree* tree) {
+    if (!tree) return;
+    if (tree->pool) pool_destroy(tree->pool);
+    else bst_free(tree->root);
+    free(tree);
+}
+
+/* Scapegoat step after an insert landed `depth` edges down: rebuild the
+ * lowest ancestor u whose own height bound fails, i.e. the new node sits
+ * more than c * log2(size(u)) below it (Galperin-Rivest). Climbing back
+ * up the insert path, each size is the one below plus the sibling
+ * subtree, so an unsized tree only counts nodes inside u. The root fails
+ * whenever the trigger fired; only u's subtree is rebuilt, so a sorted
+ * stream costs amortized O(log n) per insert instead of repeated O(n)
+ * rebuilds. */
+static void bst_rebuild_scapegoat(BSTree* tree, int key, int depth) {
+    BSTNode*** path = malloc(sizeof(BSTNode**) * (size_t)depth);
+    if (!path) {
+        bst_tree_rebalance(tree);
+        return;
+    }
+
+    BSTNode** link = &tree->root;
+    for (int i = 0; i < depth; i++) {
+        path[i] = link;
+        link = key < (*link)->key ? &(*link)->left : &(*link)->right;
+    }
+
+    BSTNode** scapegoat = &tree->root;
+    int size = 1;
+    for (int i = depth - 1; i >= 0; i--) {
+        BSTNode* u = *path[i];
+        size += 1 + bst_size(key < u->key ? u->right : u->left);
+        if (depth - i > tree->rebalance_c * bst_min_levels(size)) {
+            scapegoat = path[i];
+            break;
+        }
+    }
+    free(path);
+
+    tree->rebuilt += size;
+    *scapegoat = bst_rebalance(*scapegoat);
+    tree->rebalances++;
+}
+
+/* With auto-rebalance on, an insert that lands deeper than c * log2(n)
+ * rebuilds a scapegoat subtree; only inserts can make the tree taller. In
+ * multiset mode an existing key gains a copy. */
+BSTNode* bst_tree_insert(BSTree* tree, int key) {
+    if (!tree) return NULL;
+
+    int depth = -1;
+    BSTNode* node = bst_insert_in(tree->pool, &tree->root, key, tree->sized, &depth);
+    if (!node) return NULL;
+    if (depth < 0) {
+        if (tree->multiset) {
+            if (node->count == BST_MAX_COUNT) return NULL;
+            node->count++;
+        }
+        return node;
+    }
+    tree->nodes++;
+    if (tree->rebalance_c > 0.0 &&
+        depth > tree->rebalance_c * bst_min_levels(tree->nodes)) {
+        bst_rebuild_scapegoat(tree, key, depth);
+    }
+    return node;
+}
+
+void bst_tree_rebalance(BSTree* tree) {
+    if (!tree) return;
+    tree->rebuilt += tree->nodes;
+    tree->root = bst_rebalance(tree->root);
+    tree->rebalances++;
+}
+
+/* c <= 0 turns the automatic trigger off. c is at least 1: a fresh
+ * rebuild must sit below the threshold. */
+void bst_set_auto_rebalance(BSTree* tree, double c) {
+    if (tree) tree->rebalance_c = c <= 0.0 ? 0.0 : c < 1.0 ? 1.0 : c;
+}
+
+int bst_tree_delete(BSTree* tree, int key) {
+    if (!tree) return 0;
+    int unlinked;
+    int removed = bst_delete_in(tree->pool, &tree->root, key, tree->multiset, &unlinked);
+    tree->nodes -= unlinked;
+    return removed;
+}
+
+int bst_set_multiset(BSTree* tree, int enabled) {
+    if (!tree || tree->root) return 0;
+    tree->multiset = enabled != 0;
+    return 1;
+}
+
+int bst_set_sized(BSTree* tree, int enabled) {
+    if (!tree || tree->root) return 0;
+    tree->sized = enabled != 0;
+    return 1;
+}
+
+/* Copies of key held by the tree (0 if absent) */
+int bst_tree_count(BSTree* tree, int key) {
+    if (!tree) return 0;
+    BSTNode* node = bst_search(tree->root, key);
+    return node ? node->count : 0;
+}
+
+/* Fill an empty tree from strictly ascending keys in O(n), taking the
+ * nodes from its pool in preorder. Returns 1 on success, 0 if the tree is
+ * not empty, the keys are unsorted or memory runs out (the tree is then
+ * still empty). */
+int bst_tree_build_sorted(BSTree* tree, const int* keys, int n) {
+    if (!tree || tree->root || n < 0 || (n > 0 && !keys)) return 0;
+    if (!bst_is_ascending(keys, n)) return 0;
+    if (n == 0) return 1;
+
+    tree->root = bst_build_from(tree->pool, tree->sized, keys, n, 0);
+    if (!tree->root) return 0;
+    tree->nodes = n;
+    return 1;
+}
+
+/* As above from unsorted keys (duplicates dropped), on `threads` threads */
+int bst_tree_bulk_load(BSTree* tree, const int* keys, int n, int threads) {
+    if (!tree || tree->root || n < 0 || (n > 0 && !keys)) return 0;
+    if (n == 0) return 1;
+
+    tree->root = bst_bulk_load_in(tree->pool, tree->sized, keys, n, threads);
+    if (!tree->root) return 0;
+    tree->nodes = bst_size(tree->root);
+    return 1;
+}
+
+/* Returns the number of keys removed */
+int bst_tree_delete_range(BSTree* tree, int lo, int hi) {
+    if (!tree) return 0;
+    int removed = bst_delete_range_in(tree->pool, &tree->root, lo, hi);
+    tree->nodes -= removed;
+    return removed;
 }
@@ -0,0 +1,195 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bulk.h"
+#include "parallel.h"
+
+/* ============================================================================
+ * Parallel LSD Radix Sort
+ *
+ * Keys are mapped to uint32 with the sign bit flipped so that unsigned
+ * digit order equals signed key order. Each of the four 8-bit passes runs
+ * in two parallel phases:
+ *   1. every thread histograms its own contiguous chunk
+ *   2. after a prefix sum over (digit, thread), every thread scatters its
+ *      chunk to private, non-overlapping output ranges (stable)
+ * ============================================================================
+ */
+
+#define RADIX_BITS    8
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+#define RADIX_PASSES  4
+
+typedef struct {
+    const uint32_t *src;
+    uint32_t *dst;
+    int n;
+    int threads;
+    int shift;
+    size_t (*count)[RADIX_BUCKETS];   /* [thread][digit]; offsets after prefix */
+} RadixPass;
+
+static void bulk_chunk(int n, int threads, int tid, int *lo, int *hi) {
+    *lo = (int)((long long)n * tid / threads);
+    *hi = (int)((long long)n * (tid + 1) / threads);
+}
+
+static void radix_histogram(void *arg, int tid) {
+    RadixPass *p = (RadixPass *)arg;
+    size_t *count = p->count[tid];
+    int lo, hi;
+    bulk_chunk(p->n, p->threads, tid, &lo, &hi);
+
+    memset(count, 0, sizeof(size_t) * RADIX_BUCKETS);
+    for (int i = lo; i < hi; i++)
+        count[(p->src[i] >> p->shift) & (RADIX_BUCKETS - 1)]++;
+}
+
+static void radix_scatter(void *arg, int tid) {
+    RadixPass *p = (RadixPass *)arg;
+    size_t *offset = p->count[tid];
+    int lo, hi;
+    bulk_chunk(p->n, p->threads, tid, &lo, &hi);
+
+    for (int i = lo; i < hi; i++) {
+        uint32_t v = p->src[i];
+        p->dst[offset[(v >> p->shift) & (RADIX_BUCKETS - 1)]++] = v;
+    }
+}
+
+/* Returns the buffer holding the sorted keys (a or b) */
+static uint32_t* radix_sort(uint32_t *a, uint32_t *b, int n, int threads,
+                            size_t (*count)[RADIX_BUCKETS]) {
+    RadixPass pass = { a, b, n, threads, 0, count };
+
+    for (int d = 0; d < RADIX_PASSES; d++) {
+        pass.shift = d * RADIX_BITS;
+        par_for(threads, radix_histogram, &pass);
+
+        /* Turn counts into start offsets, digit-major then thread order */
+        size_t running = 0;
+        int single_bucket = 0;
+        for (int digit = 0; digit < RADIX_BUCKETS; digit++) {
+            size_t bucket = 0;
+            for (int t = 0; t < threads; t++) {
+                size_t c = count[t][digit];
+                count[t][digit] = running;
+                running += c;
+                bucket += c;
+            }
+            if (bucket == (size_t)n) single_bucket = 1;
+        }
+
+        /* Every key shares this digit: the pass would be a plain copy */
+        if (single_bucket) continue;
+
+        par_for(threads, radix_scatter, &pass);
+        const uint32_t *sorted = pass.dst;
+        pass.dst = (uint32_t *)pass.src;
+        pass.src = sorted;
+    }
+    return (uint32_t *)pass.src;
+}
+
+/* ============================================================================
+ * Parallel Deduplication
+ * ============================================================================
+ */
+
+typedef struct {
+    const uint32_t *sorted;
+    int *out;
+    int n;
+    int threads;
+    int *unique;     /* per thread: count, then output offset */
+} DedupPass;
+
+static int dedup_is_first(const uint32_t *a, int i) {
+    return i == 0 || a[i] != a[i - 1];
+}
+
+static void dedup_count(void *arg, int tid) {
+    DedupPass *p = (DedupPass *)arg;
+    int lo, hi, c = 0;
+    bulk_chunk(p->n, p->threads, tid, &lo, &hi);
+
+    for (int i = lo; i < hi; i++)
+        c += dedup_is_first(p->sorted, i);
+    p->unique[tid] = c;
+}
+
+static void dedup_write(void *arg, int tid) {
+    DedupPass *p = (DedupPass *)arg;
+    int lo, hi, at = p->unique[tid];
+    bulk_chunk(p->n, p->threads, tid, &lo, &hi);
+
+    for (int i = lo; i < hi; i++)
+        if (dedup_is_first(p->sorted, i))
+            p->out[at++] = (int)(p->sorted[i] ^ 0x80000000u);
+}
+
+/* ============================================================================
+ * Public Entry Point
+ * ============================================================================
+ */
+
+typedef struct {
+    const int *keys;
+    uint32_t *dst;
+    int n;
+    int threads;
+} FlipPass;
+
+static void bulk_flip(void *arg, int tid) {
+    FlipPass *p = (FlipPass *)arg;
+    int lo, hi;
+    bulk_chunk(p->n, p->threads, tid, &lo, &hi);
+
+    for (int i = lo; i < hi; i++)
+        p->dst[i] = (uint32_t)p->keys[i] ^ 0x80000000u;
+}
+
+int bulk_sort_unique(const int *keys, int n, int threads, int **out) {
+    if (!out) return -1;
+    *out = NULL;
+    if (n < 0 || (n > 0 && !keys)) return -1;
+
+    threads = par_threads(threads);
+    if (n < PAR_GRAIN * threads) threads = n / PAR_GRAIN > 1 ? n / PAR_GRAIN : 1;
+
+    size_t bytes = sizeof(uint32_t) * (size_t)(n > 0 ? n : 1);
+    uint32_t *a = malloc(bytes);
+    uint32_t *b = malloc(bytes);
+    size_t (*count)[RADIX_BUCKETS] = malloc(sizeof(*count) * (size_t)threads);
+    int *unique = malloc(sizeof(int) * (size_t)threads);
+    if (!a || !b || !count || !unique) {
+        free(a);
+        free(b);
+        free(count);
+        free(unique);
+        return -1;
+    }
+
+    FlipPass flip = { keys, a, n, threads };
+    par_for(threads, bulk_flip, &flip);
+
+    uint32_t *sorted = radix_sort(a, b, n, threads, count);
+    uint32_t *spare = (sorted == a) ? b : a;
+
+    /* Deduplicate into the spare buffer (uint32 and int have equal size) */
+    DedupPass dedup = { sorted, (int *)spare, n, threads, unique };
+    par_for(threads, dedup_count, &dedup);
+    int total = 0;
+    for (int t = 0; t < threads; t++) {
+        int c = unique[t];
+        unique[t] = total;
+        total += c;
+    }
+    par_for(threads, dedup_write, &dedup);
+
+    free(sorted);
+    free(count);
+    free(unique);
+    *out = (int *)spare;
+    return total;
+}
@@ -0,0 +1,521 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include "compact.h"
+
+/* ============================================================================
+ * Shared Array Growth
+ * ============================================================================
+ */
+
+/* Grow a node array so that slot `need` (at most max_index) is
+ * addressable. Indices stay valid across the realloc, which is the whole
+ * point of linking by index. */
+static int compact_reserve(void **nodes, uint32_t *capacity, uint32_t need,
+                           uint32_t max_index, size_t node_size) {
+    if (need < *capacity) return 1;
+    if (need > max_index) return 0;
+
+    uint64_t cap = *capacity ? *capacity : 16;
+    while (cap <= need) cap *= 2;
+    if (cap > (uint64_t)max_index + 1) cap = (uint64_t)max_index + 1;
+    if (cap > SIZE_MAX / node_size) return 0;
+
+    void *grown = realloc(*nodes, (size_t)cap * node_size);
+    if (!grown) return 0;
+    *nodes = grown;
+    *capacity = (uint32_t)cap;
+    return 1;
+}
+
+/* ============================================================================
+ * Compact AVL
+ * ============================================================================
+ */
+
+/* The height field holds levels (height + 1): NIL is 0, a leaf 1 */
+#define AVL_HEIGHT_SHIFT COMPACT_INDEX_BITS
+
+static uint32_t cavl_left(const CompactAVL *t, uint32_t i) {
+    return COMPACT_IDX(t->nodes[i].left);
+}
+
+static uint32_t cavl_right(const CompactAVL *t, uint32_t i) {
+    return t->nodes[i].right;
+}
+
+static uint32_t cavl_height(const CompactAVL *t, uint32_t i) {
+    return t->nodes[i].left >> AVL_HEIGHT_SHIFT;
+}
+
+static void cavl_set_left(CompactAVL *t, uint32_t i, uint32_t child) {
+    t->nodes[i].left = (t->nodes[i].left & ~COMPACT_INDEX_MASK) | child;
+}
+
+static void cavl_update_height(CompactAVL *t, uint32_t i) {
+    uint32_t hl = cavl_height(t, cavl_left(t, i));
+    uint32_t hr = cavl_height(t, cavl_right(t, i));
+    uint32_t h = 1 + (hl > hr ? hl : hr);
+    t->nodes[i].left = (h << AVL_HEIGHT_SHIFT) | cavl_left(t, i);
+}
+
+static int cavl_balance(const CompactAVL *t, uint32_t i) {
+    return (int)cavl_height(t, cavl_left(t, i)) - (int)cavl_height(t, cavl_right(t, i));
+}
+
+int compact_avl_init(CompactAVL *tree, uint32_t capacity_hint) {
+    if (!tree) return 0;
+    tree->nodes = NULL;
+    tree->capacity = 0;
+    tree->used = 1;
+    tree->free_head = COMPACT_NIL;
+    tree->root = COMPACT_NIL;
+    tree->size = 0;
+
+    if (!compact_reserve((void **)&tree->nodes, &tree->capacity,
+                         capacity_hint, COMPACT_MAX_NODES, sizeof(CompactAVLNode)))
+        return 0;
+
+    /* NIL sentinel: no levels (height -1), no children */
+    tree->nodes[0].key = 0;
+    tree->nodes[0].left = 0;
+    tree->nodes[0].right = 0;
+    return 1;
+}
+
+void compact_avl_free(CompactAVL *tree) {
+    if (!tree) return;
+    free(tree->nodes);
+    tree->nodes = NULL;
+    tree->capacity = tree->used = 0;
+    tree->root = tree->free_head = COMPACT_NIL;
+    tree->size = 0;
+}
+
+static uint32_t cavl_alloc(CompactAVL *t, int key) {
+    uint32_t i;
+    if (t->free_head != COMPACT_NIL) {
+        i = t->free_head;
+        t->free_head = t->nodes[i].right;
+    } else {
+        if (!compact_reserve((void **)&t->nodes, &t->capacity, t->used,
+                             COMPACT_MAX_NODES, sizeof(CompactAVLNode)))
+            return COMPACT_NIL;
+        i = t->used++;
+    }
+    t->nodes[i].key = key;
+    t->nodes[i].left = 1u << AVL_HEIGHT_SHIFT;  /* one level, no left child */
+    t->nodes[i].right = COMPACT_NIL;
+    return i;
+}
+
+static void cavl_release(CompactAVL *t, uint32_t i) {
+    t->nodes[i].right = t->free_head;
+    t->free_head = i;
+}
+
+static uint32_t cavl_rotate_right(CompactAVL *t, uint32_t y) {
+    uint32_t x = cavl_left(t, y);
+    cavl_set_left(t, y, cavl_right(t, x));
+    t->nodes[x].right = y;
+    cavl_update_height(t, y);
+    cavl_update_height(t, x);
+    return x;
+}
+
+static uint32_t cavl_rotate_left(CompactAVL *t, uint32_t x) {
+    uint32_t y = cavl_right(t, x);
+    t->nodes[x].right = cavl_left(t, y);
+    cavl_set_left(t, y, x);
+    cavl_update_height(t, x);
+    cavl_update_height(t, y);
+    return y;
+}
+
+static uint32_t cavl_rebalance(CompactAVL *t, uint32_t n) {
+    cavl_update_height(t, n);
+    int bf = cavl_balance(t, n);
+
+    if (bf > 1) {
+        if (cavl_balance(t, cavl_left(t, n)) < 0)
+            cavl_set_left(t, n, cavl_rotate_left(t, cavl_left(t, n)));
+        return cavl_rotate_right(t, n);
+    }
+    if (bf < -1) {
+        if (cavl_balance(t, cavl_right(t, n)) > 0)
+            t->nodes[n].right = cavl_rotate_right(t, cavl_right(t, n));
+        return cavl_rotate_left(t, n);
+    }
+    return n;
+}
+
+/* Recursive insert; *out receives the node holding key. The array may be
+ * reallocated by cavl_alloc, so children are stored only after the call. */
+static uint32_t cavl_insert_at(CompactAVL *t, uint32_t n, int key, uint32_t *out) {
+    if (n == COMPACT_NIL) {
+        *out = cavl_alloc(t, key);
+        if (*out != COMPACT_NIL) t->size++;
+        return *out;
+    }
+
+    if (key < t->nodes[n].key) {
+        uint32_t child = cavl_insert_at(t, cavl_left(t, n), key, out);
+        cavl_set_left(t, n, child);
+    } else if (key > t->nodes[n].key) {
+        uint32_t child = cavl_insert_at(t, cavl_right(t, n), key, out);
+        t->nodes[n].right = child;
+    } else {
+        *out = n;  /* no duplicates */
+        return n;
+    }
+    return cavl_rebalance(t, n);
+}
+
+uint32_t compact_avl_insert(CompactAVL *tree, int key) {
+    if (!tree || !tree->nodes) return COMPACT_NIL;
+    uint32_t out = COMPACT_NIL;
+    tree->root = cavl_insert_at(tree, tree->root, key, &out);
+    return out;
+}
+
+static uint32_t cavl_delete_at(CompactAVL *t, uint32_t n, int key, int *removed) {
+    if (n == COMPACT_NIL) return COMPACT_NIL;
+
+    if (key < t->nodes[n].key) {
+        cavl_set_left(t, n, cavl_delete_at(t, cavl_left(t, n), key, removed));
+    } else if (key > t->nodes[n].key) {
+        t->nodes[n].right = cavl_delete_at(t, cavl_right(t, n), key, removed);
+    } else {
+        uint32_t l = cavl_left(t, n);
+        uint32_t r = cavl_right(t, n);
+        if (l == COMPACT_NIL || r == COMPACT_NIL) {
+            *removed = 1;
+            cavl_release(t, n);
+            return l != COMPACT_NIL ? l : r;
+        }
+        uint32_t succ = r;
+        while (cavl_left(t, succ) != COMPACT_NIL) succ = cavl_left(t, succ);
+        t->nodes[n].key = t->nodes[succ].key;
+        t->nodes[n].right = cavl_delete_at(t, r, t->nodes[succ].key, removed);
+    }
+    return cavl_rebalance(t, n);
+}
+
+int compact_avl_delete(CompactAVL *tree, int key) {
+    if (!tree || !tree->nodes) return 0;
+    int removed = 0;
+    tree->root = cavl_delete_at(tree, tree->root, key, &removed);
+    if (removed) tree->size--;
+    return removed;
+}
+
+uint32_t compact_avl_search(const CompactAVL *tree, int key) {
+    if (!tree || !tree->nodes) return COMPACT_NIL;
+    uint32_t n = tree->root;
+    while (n != COMPACT_NIL && tree->nodes[n].key != key)
+        n = key < tree->nodes[n].key ? cavl_left(tree, n) : cavl_right(tree, n);
+    return n;
+}
+
+int compact_avl_height(const CompactAVL *tree) {
+    if (!tree || !tree->nodes) return -1;
+    return COMPACT_AVL_HEIGHT(tree->nodes[tree->root].left);
+}
+
+/* ============================================================================
+ * Compact Red-Black Tree
+ * ============================================================================
+ */
+
+#define CRB_BLACK_BIT (1u << 31)
+
+static uint32_t crb_parent(const CompactRBT *t, uint32_t i) {
+    return COMPACT_RB_IDX(t->nodes[i].parent);
+}
+
+static int crb_is_red(const CompactRBT *t, uint32_t i) {
+    return i != COMPACT_NIL && !(t->nodes[i].parent & CRB_BLACK_BIT);
+}
+
+static void crb_set_parent(CompactRBT *t, uint32_t i, uint32_t p) {
+    t->nodes[i].parent = (t->nodes[i].parent & ~COMPACT_RB_INDEX_MASK) | p;
+}
+
+static void crb_set_black(CompactRBT *t, uint32_t i) {
+    t->nodes[i].parent |= CRB_BLACK_BIT;
+}
+
+static void crb_set_red(CompactRBT *t, uint32_t i) {
+    t->nodes[i].parent &= ~CRB_BLACK_BIT;
+}
+
+/* Give i the color of from */
+static void crb_copy_color(CompactRBT *t, uint32_t i, uint32_t from) {
+    t->nodes[i].parent = (t->nodes[i].parent & ~CRB_BLACK_BIT) |
+                         (t->nodes[from].parent & CRB_BLACK_BIT);
+}
+
+int compact_rbt_init(CompactRBT *tree, uint32_t capacity_hint) {
+    if (!tree) return 0;
+    tree->nodes = NULL;
+    tree->capacity = 0;
+    tree->used = 1;
+    tree->free_head = COMPACT_NIL;
+    tree->root = COMPACT_NIL;
+    tree->size = 0;
+
+    if (!compact_reserve((void **)&tree->nodes, &tree->capacity,
+                         capacity_hint, COMPACT_RB_MAX_NODES, sizeof(CompactRBNode)))
+        return 0;
+
+    /* NIL sentinel is BLACK */
+    tree->nodes[0].key = 0;
+    tree->nodes[0].left = tree->nodes[0].right = COMPACT_NIL;
+    tree->nodes[0].parent = CRB_BLACK_BIT;
+    return 1;
+}
+
+void compact_rbt_free(CompactRBT *tree) {
+    if (!tree) return;
+    free(tree->nodes);
+    tree->nodes = NULL;
+    tree->capacity = tree->used = 0;
+    tree->root = tree->free_head = COMPACT_NIL;
+    tree->size = 0;
+}
+
+/* A RED node with no children, or NIL if the array cannot grow */
+static uint32_t crb_alloc(CompactRBT *t, int key, uint32_t parent) {
+    uint32_t i;
+    if (t->free_head != COMPACT_NIL) {
+        i = t->free_head;
+        t->free_head = t->nodes[i].right;
+    } else {
+        if (!compact_reserve((void **)&t->nodes, &t->capacity, t->used,
+                             COMPACT_RB_MAX_NODES, sizeof(CompactRBNode)))
+            return COMPACT_NIL;
+        i = t->used++;
+    }
+    t->nodes[i].key = key;
+    t->nodes[i].left = t->nodes[i].right = COMPACT_NIL;
+    t->nodes[i].parent = parent;  /* RED */
+    return i;
+}
+
+static void crb_release(CompactRBT *t, uint32_t i) {
+    t->nodes[i].right = t->free_head;
+    t->free_head = i;
+}
+
+/* Replace x by y under x's parent. y may be NIL: the sentinel's parent is
+ * set anyway, since the delete fix-up climbs from it. */
+static void crb_replace_child(CompactRBT *t, uint32_t x, uint32_t y) {
+    uint32_t p = crb_parent(t, x);
+    crb_set_parent(t, y, p);
+    if (p == COMPACT_NIL)
+        t->root = y;
+    else if (t->nodes[p].left == x)
+        t->nodes[p].left = y;
+    else
+        t->nodes[p].right = y;
+}
+
+static void crb_left_rotate(CompactRBT *t, uint32_t x) {
+    uint32_t y = t->nodes[x].right;
+    t->nodes[x].right = t->nodes[y].left;
+    if (t->nodes[y].left != COMPACT_NIL)
+        crb_set_parent(t, t->nodes[y].left, x);
+    crb_replace_child(t, x, y);
+    t->nodes[y].left = x;
+    crb_set_parent(t, x, y);
+}
+
+static void crb_right_rotate(CompactRBT *t, uint32_t x) {
+    uint32_t y = t->nodes[x].left;
+    t->nodes[x].left = t->nodes[y].right;
+    if (t->nodes[y].right != COMPACT_NIL)
+        crb_set_parent(t, t->nodes[y].right, x);
+    crb_replace_child(t, x, y);
+    t->nodes[y].right = x;
+    crb_set_parent(t, x, y);
+}
+
+/* Same case analysis as rbt_insert_fixup, without the learning trace */
+static void crb_insert_fixup(CompactRBT *t, uint32_t z) {
+    while (crb_is_red(t, crb_parent(t, z))) {
+        uint32_t p = crb_parent(t, z);
+        uint32_t gp = crb_parent(t, p);
+
+        if (p == t->nodes[gp].left) {
+            uint32_t y = t->nodes[gp].right;
+            if (crb_is_red(t, y)) {
+                crb_set_black(t, p);
+                crb_set_black(t, y);
+                crb_set_red(t, gp);
+                z = gp;
+            } else {
+                if (z == t->nodes[p].right) {
+                    z = p;
+                    crb_left_rotate(t, z);
+                    p = crb_parent(t, z);
+                }
+                crb_set_black(t, p);
+                crb_set_red(t, gp);
+                crb_right_rotate(t, gp);
+            }
+        } else {
+            uint32_t y = t->nodes[gp].left;
+            if (crb_is_red(t, y)) {
+                crb_set_black(t, p);
+                crb_set_black(t, y);
+                crb_set_red(t, gp);
+                z = gp;
+            } else {
+                if (z == t->nodes[p].left) {
+                    z = p;
+                    crb_right_rotate(t, z);
+                    p = crb_parent(t, z);
+                }
+                crb_set_black(t, p);
+                crb_set_red(t, gp);
+                crb_left_rotate(t, gp);
+            }
+        }
+    }
+    crb_set_black(t, t->root);
+}
+
+/* A present key returns its node, as in the compact AVL */
+uint32_t compact_rbt_insert(CompactRBT *tree, int key) {
+    if (!tree || !tree->nodes) return COMPACT_NIL;
+
+    uint32_t y = COMPACT_NIL;
+    uint32_t x = tree->root;
+    while (x != COMPACT_NIL) {
+        if (key == tree->nodes[x].key) return x;
+        y = x;
+        x = (key < tree->nodes[x].key) ? tree->nodes[x].left : tree->nodes[x].right;
+    }
+
+    uint32_t z = crb_alloc(tree, key, y);
+    if (z == COMPACT_NIL) return COMPACT_NIL;
+
+    if (y == COMPACT_NIL)
+        tree->root = z;
+    else if (key < tree->nodes[y].key)
+        tree->nodes[y].left = z;
+    else
+        tree->nodes[y].right = z;
+
+    tree->size++;
+    crb_insert_fixup(tree, z);
+    return z;
+}
+
+/* Same case analysis as rbt_delete_fixup. x may be the NIL sentinel, whose
+ * parent word then tells where the removed BLACK node was. */
+static void crb_delete_fixup(CompactRBT *t, uint32_t x) {
+    while (x != t->root && !crb_is_red(t, x)) {
+        uint32_t p = crb_parent(t, x);
+
+        if (x == t->nodes[p].left) {
+            uint32_t w = t->nodes[p].right;
+            if (crb_is_red(t, w)) {
+                crb_set_black(t, w);
+                crb_set_red(t, p);
+                crb_left_rotate(t, p);
+                w = t->nodes[p].right;
+            }
+            if (!crb_is_red(t, t->nodes[w].left) && !crb_is_red(t, t->nodes[w].right)) {
+                crb_set_red(t, w);
+                x = p;
+            } else {
+                if (!crb_is_red(t, t->nodes[w].right)) {
+                    crb_set_black(t, t->nodes[w].left);
+                    crb_set_red(t, w);
+                    crb_right_rotate(t, w);
+                    w = t->nodes[p].right;
+                }
+                crb_copy_color(t, w, p);
+                crb_set_black(t, p);
+                crb_set_black(t, t->nodes[w].right);
+                crb_left_rotate(t, p);
+                x = t->root;
+            }
+        } else {
+            uint32_t w = t->nodes[p].left;
+            if (crb_is_red(t, w)) {
+                crb_set_black(t, w);
+                crb_set_red(t, p);
+                crb_right_rotate(t, p);
+                w = t->nodes[p].left;
+            }
+            if (!crb_is_red(t, t->nodes[w].left) && !crb_is_red(t, t->nodes[w].right)) {
+                crb_set_red(t, w);
+                x = p;
+            } else {
+                if (!crb_is_red(t, t->nodes[w].left)) {
+                    crb_set_black(t, t->nodes[w].right);
+                    crb_set_red(t, w);
+                    crb_left_rotate(t, w);
+                    w = t->nodes[p].left;
+                }
+                crb_copy_color(t, w, p);
+                crb_set_black(t, p);
+                crb_set_black(t, t->nodes[w].left);
+                crb_right_rotate(t, p);
+                x = t->root;
+            }
+        }
+    }
+    crb_set_black(t, x);
+}
+
+/* A node with two children is replaced by its successor node (relinked,
+ * so other indices stay put); the slot goes on the free list. Returns 1
+ * if key was present. */
+int compact_rbt_delete(CompactRBT *tree, int key) {
+    uint32_t z = compact_rbt_search(tree, key);
+    if (z == COMPACT_NIL) return 0;
+
+    CompactRBNode *n = tree->nodes;
+    uint32_t x;
+    int removed_black = !crb_is_red(tree, z);
+
+    if (n[z].left == COMPACT_NIL) {
+        x = n[z].right;
+        crb_replace_child(tree, z, x);
+    } else if (n[z].right == COMPACT_NIL) {
+        x = n[z].left;
+        crb_replace_child(tree, z, x);
+    } else {
+        uint32_t y = n[z].right;
+        while (n[y].left != COMPACT_NIL) y = n[y].left;
+        removed_black = !crb_is_red(tree, y);
+        x = n[y].right;
+
+        if (crb_parent(tree, y) == z) {
+            crb_set_parent(tree, x, y);
+        } else {
+            crb_replace_child(tree, y, x);
+            n[y].right = n[z].right;
+            crb_set_parent(tree, n[y].right, y);
+        }
+        crb_replace_child(tree, z, y);
+        n[y].left = n[z].left;
+        crb_set_parent(tree, n[y].left, y);
+        crb_copy_color(tree, y, z);
+    }
+
+    crb_release(tree, z);
+    tree->size--;
+    if (removed_black) crb_delete_fixup(tree, x);
+    return 1;
+}
+
+uint32_t compact_rbt_search(const CompactRBT *tree, int key) {
+    if (!tree || !tree->nodes) return COMPACT_NIL;
+    uint32_t n = tree->root;
+    while (n != COMPACT_NIL && tree->nodes[n].key != key)
+        n = key < tree->nodes[n].key ? tree->nodes[n].left : tree->nodes[n].right;
+    return n;
+}
@@ -0,0 +1,151 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include "hash_index.h"
+
+/* ============================================================================
+ * Open-Addressing Hash Index Implementation
+ *
+ * Fibonacci hashing picks the home slot from the top bits of key * 2^64/phi,
+ * which spreads runs of consecutive keys evenly over the table.
+ * ============================================================================
+ */
+
+typedef struct {
+    void *value;             /* NULL: empty */
+    int key;
+} HashSlot;
+
+struct HashIndex {
+    HashSlot *slots;
+    size_t mask;             /* Slot count - 1 */
+    int shift;               /* 64 - log2(slot count) */
+    size_t count;
+};
+
+static size_t hash_index_home(const HashIndex *index, int key) {
+    return (size_t)(((uint64_t)(uint32_t)key * 0x9E3779B97F4A7C15ULL) >> index->shift);
+}
+
+/* Smallest power of two >= 2 * capacity: the table stays at most half full */
+static size_t hash_index_slots_for(size_t capacity) {
+    size_t slots = HASH_INDEX_MIN_SLOTS;
+    while (slots / 2 < capacity) slots *= 2;
+    return slots;
+}
+
+/* Swap in an empty table of `slots` slots, returning the old one */
+static HashSlot* hash_index_swap(HashIndex *index, size_t slots, HashSlot **old) {
+    HashSlot *table = (HashSlot *)calloc(slots, sizeof(HashSlot));
+    if (!table) return NULL;
+
+    int bits = 0;
+    while (((size_t)1 << bits) < slots) bits++;
+    *old = index->slots;
+    index->slots = table;
+    index->mask = slots - 1;
+    index->shift = 64 - bits;
+    index->count = 0;
+    return table;
+}
+
+HashIndex* hash_index_create(size_t capacity) {
+    HashIndex *index = (HashIndex *)malloc(sizeof(HashIndex));
+    if (!index) return NULL;
+
+    HashSlot *old;
+    index->slots = NULL;
+    if (!hash_index_swap(index, hash_index_slots_for(capacity), &old)) {
+        free(index);
+        return NULL;
+    }
+    return index;
+}
+
+void hash_index_destroy(HashIndex *index) {
+    if (!index) return;
+    free(index->slots);
+    free(index);
+}
+
+int hash_index_reset(HashIndex *index, size_t capacity) {
+    if (!index) return 0;
+
+    HashSlot *old;
+    if (!hash_index_swap(index, hash_index_slots_for(capacity), &old)) return 0;
+    free(old);
+    return 1;
+}
+
+/* Double the table and reinsert every entry */
+static int hash_index_grow(HashIndex *index) {
+    size_t slots = index->mask + 1;
+    HashSlot *old;
+    if (!hash_index_swap(index, slots * 2, &old)) return 0;
+
+    for (size_t i = 0; i < slots; i++) {
+        if (old[i].value) hash_index_put(index, old[i].key, old[i].value);
+    }
+    free(old);
+    return 1;
+}
+
+int hash_index_put(HashIndex *index, int key, void *value) {
+    if (!index || !value) return 0;
+
+    size_t i = hash_index_home(index, key);
+    while (index->slots[i].value) {
+        if (index->slots[i].key == key) {
+            index->slots[i].value = value;
+            return 1;
+        }
+        i = (i + 1) & index->mask;
+    }
+
+    if ((index->count + 1) * 2 > index->mask + 1) {
+        if (!hash_index_grow(index)) return 0;
+        return hash_index_put(index, key, value);
+    }
+    index->slots[i].key = key;
+    index->slots[i].value = value;
+    index->count++;
+    return 1;
+}
+
+/* Backward-shift delete: walk the probe run after the hole and move back
+ * every entry whose home slot does not lie between the hole and itself */
+int hash_index_remove(HashIndex *index, int key) {
+    if (!index) return 0;
+
+    size_t hole = hash_index_home(index, key);
+    while (index->slots[hole].value && index->slots[hole].key != key) {
+        hole = (hole + 1) & index->mask;
+    }
+    if (!index->slots[hole].value) return 0;
+
+    for (size_t j = (hole + 1) & index->mask; index->slots[j].value;
+         j = (j + 1) & index->mask) {
+        size_t home = hash_index_home(index, index->slots[j].key);
+        if (((j - home) & index->mask) >= ((j - hole) & index->mask)) {
+            index->slots[hole] = index->slots[j];
+            hole = j;
+        }
+    }
+    index->slots[hole].value = NULL;
+    index->count--;
+    return 1;
+}
+
+void* hash_index_get(const HashIndex *index, int key) {
+    if (!index) return NULL;
+
+    size_t i = hash_index_home(index, key);
+    while (index->slots[i].value) {
+        if (index->slots[i].key == key) return index->slots[i].value;
+        i = (i + 1) & index->mask;
+    }
+    return NULL;
+}
+
+size_t hash_index_count(const HashIndex *index) {
+    return index ? index->count : 0;
+}
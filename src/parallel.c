@@ -0,0 +1,147 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdlib.h>
+#include "parallel.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+typedef HANDLE par_thread_t;
+#else
+#include <pthread.h>
+#include <unistd.h>
+typedef pthread_t par_thread_t;
+#endif
+
+/* ============================================================================
+ * Platform Threads
+ * ============================================================================
+ */
+
+typedef struct {
+    ParTask fn;
+    void *arg;
+} ParStart;
+
+#if defined(_WIN32)
+static DWORD WINAPI par_trampoline(LPVOID p) {
+    ParStart *start = (ParStart *)p;
+    start->fn(start->arg);
+    return 0;
+}
+
+static int par_thread_start(par_thread_t *thread, ParStart *start) {
+    *thread = CreateThread(NULL, 0, par_trampoline, start, 0, NULL);
+    return *thread != NULL;
+}
+
+static void par_thread_join(par_thread_t thread) {
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+#else
+static void* par_trampoline(void *p) {
+    ParStart *start = (ParStart *)p;
+    start->fn(start->arg);
+    return NULL;
+}
+
+static int par_thread_start(par_thread_t *thread, ParStart *start) {
+    return pthread_create(thread, NULL, par_trampoline, start) == 0;
+}
+
+static void par_thread_join(par_thread_t thread) {
+    pthread_join(thread, NULL);
+}
+#endif
+
+int par_cpu_count(void) {
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#endif
+}
+
+int par_threads(int requested) {
+    return requested > 0 ? requested : par_cpu_count();
+}
+
+int par_spawn_depth(int threads) {
+    int depth = 0;
+    while ((1 << depth) < threads && depth < 16) depth++;
+    return depth;
+}
+
+/* ============================================================================
+ * Fork-Join
+ * ============================================================================
+ */
+
+void par_invoke(ParTask a, void *arg_a, ParTask b, void *arg_b) {
+    ParStart start = { a, arg_a };
+    par_thread_t thread;
+
+    if (!par_thread_start(&thread, &start)) {
+        a(arg_a);
+        b(arg_b);
+        return;
+    }
+    b(arg_b);
+    par_thread_join(thread);
+}
+
+typedef struct {
+    ParRangeTask fn;
+    void *arg;
+    int tid;
+} ParForSlot;
+
+static void par_for_slot(void *p) {
+    ParForSlot *slot = (ParForSlot *)p;
+    slot->fn(slot->arg, slot->tid);
+}
+
+void par_for(int threads, ParRangeTask fn, void *arg) {
+    if (threads <= 1) {
+        fn(arg, 0);
+        return;
+    }
+
+    ParForSlot *slots = malloc(sizeof(ParForSlot) * (size_t)threads);
+    ParStart *starts = malloc(sizeof(ParStart) * (size_t)threads);
+    par_thread_t *handles = malloc(sizeof(par_thread_t) * (size_t)threads);
+    int *started = calloc((size_t)threads, sizeof(int));
+    if (!slots || !starts || !handles || !started) {
+        for (int t = 0; t < threads; t++) fn(arg, t);
+        free(slots);
+        free(starts);
+        free(handles);
+        free(started);
+        return;
+    }
+
+    /* Slot 0 runs on the calling thread */
+    for (int t = 1; t < threads; t++) {
+        slots[t].fn = fn;
+        slots[t].arg = arg;
+        slots[t].tid = t;
+        starts[t].fn = par_for_slot;
+        starts[t].arg = &slots[t];
+        started[t] = par_thread_start(&handles[t], &starts[t]);
+    }
+    fn(arg, 0);
+    for (int t = 1; t < threads; t++) {
+        if (started[t]) par_thread_join(handles[t]);
+        else fn(arg, t);
+    }
+
+    free(slots);
+    free(starts);
+    free(handles);
+    free(started);
+}
@@ -0,0 +1,139 @@
+#include <stdlib.h>
+#include "pool.h"
+
+#if defined(_WIN32)
+#include <malloc.h>
+#define pool_aligned_alloc(size) _aligned_malloc((size), POOL_CACHE_LINE)
+#define pool_aligned_free(ptr)   _aligned_free(ptr)
+#else
+#define pool_aligned_alloc(size) aligned_alloc(POOL_CACHE_LINE, (size))
+#define pool_aligned_free(ptr)   free(ptr)
+#endif
+
+/* ============================================================================
+ * Slab Node Pool Implementation
+ *
+ * Slab layout (every slab starts on a cache line):
+ *
+ *   [ next-slab link | pad to 64 ][ node 0 ][ node 1 ] ... [ node N-1 ]
+ *
+ * Fresh nodes are handed out by bumping through the newest slab; freed
+ * nodes are threaded through their first word onto the free list.
+ * ============================================================================
+ */
+
+struct NodePool {
+    size_t node_size;        /* Rounded up to hold a free-list link */
+    size_t nodes_per_slab;
+    size_t slab_bytes;
+    void *slabs;             /* Newest slab first */
+    unsigned char *bump;     /* Next never-used node in newest slab */
+    size_t bump_left;
+    void *free_list;
+    size_t slab_count;
+    size_t live;
+    size_t owners;
+};
+
+/* Round n up to a multiple of align (align is a power of two) */
+static size_t pool_round_up(size_t n, size_t align) {
+    return (n + align - 1) & ~(align - 1);
+}
+
+NodePool* pool_create(size_t node_size, size_t nodes_per_slab) {
+    if (node_size == 0) return NULL;
+
+    NodePool *pool = (NodePool *)malloc(sizeof(NodePool));
+    if (!pool) return NULL;
+
+    if (node_size < sizeof(void *)) node_size = sizeof(void *);
+    pool->node_size = pool_round_up(node_size, sizeof(void *));
+    pool->nodes_per_slab = nodes_per_slab ? nodes_per_slab : POOL_DEFAULT_SLAB_NODES;
+    pool->slab_bytes = pool_round_up(POOL_CACHE_LINE +
+                                     pool->node_size * pool->nodes_per_slab,
+                                     POOL_CACHE_LINE);
+    pool->slabs = NULL;
+    pool->bump = NULL;
+    pool->bump_left = 0;
+    pool->free_list = NULL;
+    pool->slab_count = 0;
+    pool->live = 0;
+    pool->owners = 1;
+    return pool;
+}
+
+NodePool* pool_retain(NodePool *pool) {
+    if (pool) pool->owners++;
+    return pool;
+}
+
+/* Drop one owner; the last one releases every slab in one pass without
+ * visiting nodes */
+void pool_destroy(NodePool *pool) {
+    if (!pool) return;
+    if (--pool->owners > 0) return;
+
+    void *slab = pool->slabs;
+    while (slab) {
+        void *next = *(void **)slab;
+        pool_aligned_free(slab);
+        slab = next;
+    }
+    free(pool);
+}
+
+/* Add a new slab to the front of the slab list */
+static int pool_grow(NodePool *pool) {
+    unsigned char *slab = (unsigned char *)pool_aligned_alloc(pool->slab_bytes);
+    if (!slab) return 0;
+
+    *(void **)slab = pool->slabs;
+    pool->slabs = slab;
+    pool->bump = slab + POOL_CACHE_LINE;
+    pool->bump_left = pool->nodes_per_slab;
+    pool->slab_count++;
+    return 1;
+}
+
+void* pool_alloc(NodePool *pool) {
+    if (!pool) return NULL;
+
+    void *node;
+    if (pool->free_list) {
+        /* Recycle the most recently freed node (likely still cached) */
+        node = pool->free_list;
+        pool->free_list = *(void **)node;
+    } else {
+        if (!pool->bump_left && !pool_grow(pool)) return NULL;
+        node = pool->bump;
+        pool->bump += pool->node_size;
+        pool->bump_left--;
+    }
+
+    pool->live++;
+    return node;
+}
+
+void pool_free(NodePool *pool, void *node) {
+    if (!pool || !node) return;
+
+    *(void **)node = pool->free_list;
+    pool->free_list = node;
+    pool->live--;
+}
+
+size_t pool_live(const NodePool *pool) {
+    return pool ? pool->live : 0;
+}
+
+size_t pool_slab_count(const NodePool *pool) {
+    return pool ? pool->slab_count : 0;
+}
+
+size_t pool_owners(const NodePool *pool) {
+    return pool ? pool->owners : 0;
+}
+
+size_t pool_slab_nodes(const NodePool *pool) {
+    return pool ? pool->nodes_per_slab : 0;
+}
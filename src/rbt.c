@@ -1,4 +1,7 @@
 #include "rbt.h"
+#include "bulk.h"
+#include "parallel.h"
+#include "prefetch.h"
 #include <stdarg.h>
 
 /* ============================================================================
@@ -11,10 +14,8 @@ const char* rbt_color_string(Color color) {
     return color == RED ? "RED" : "BLACK";
 }
 
-/* Helper: Log message if verbose mode enabled */
-static void rbt_log(RBTree *tree, const char *fmt, ...) {
-    if (!tree || !tree->verbose) return;
-    
+/* Helper: Write one trace line (only reached through rbt_log) */
+static void rbt_log_write(const char *fmt, ...) {
     va_list args;
     va_start(args, fmt);
     fprintf(stdout, "[RBT] ");
@@ -23,27 +24,149 @@ static void rbt_log(RBTree *tree, const char *fmt, ...) {
     va_end(args);
 }
 
+/* Log message if verbose mode enabled. A macro so that with verbose off the
+ * trace arguments (color strings, key loads) are never evaluated. */
+#define rbt_log(tree, ...) \
+    do { if ((tree)->verbose) rbt_log_write(__VA_ARGS__); } while (0)
+
 /* Create a new RB tree */
 RBTree* rbt_create(void) {
     RBTree *tree = (RBTree *)malloc(sizeof(RBTree));
     if (!tree) return NULL;
     tree->root = NULL;
     tree->verbose = 0;
+    tree->max = NULL;
+    tree->finger = NULL;
+    tree->pool = NULL;
+    tree->bloom = NULL;
+    tree->index = NULL;
+    tree->multiset = 0;
+    tree->augmented = 0;
+    tree->refreshed = 0;
+    return tree;
+}
+
+/* Create a new RB tree whose nodes come from a slab pool */
+RBTree* rbt_create_pooled(size_t nodes_per_slab) {
+    RBTree *tree = rbt_create();
+    if (!tree) return NULL;
+    tree->pool = pool_create(sizeof(RBNode), nodes_per_slab);
+    if (!tree->pool) {
+        free(tree);
+        return NULL;
+    }
     return tree;
 }
 
-/* Create a new RB node */
-static RBNode* rbt_node_create(int key) {
-    RBNode *node = (RBNode *)malloc(sizeof(RBNode));
+/* Create a new RB node (an RBAugNode in augmented mode) */
+static RBNode* rbt_node_create(RBTree *tree, int key) {
+    size_t bytes = tree->augmented ? sizeof(RBAugNode) : sizeof(RBNode);
+    RBNode *node = tree->pool ? (RBNode *)pool_alloc(tree->pool)
+                              : (RBNode *)malloc(bytes);
     if (!node) return NULL;
     node->key = key;
     node->color = RED;  /* New nodes are always RED */
+    node->augmented = tree->augmented;
+    node->count = 1;
+    if (tree->augmented) {
+        RB_AUG(node)->size = 1;
+        RB_AUG(node)->high = key;
+        RB_AUG(node)->max_high = key;
+    }
     node->left = NULL;
     node->right = NULL;
     node->parent = NULL;
     return node;
 }
 
+/* Return a node to the tree's pool or the heap */
+static void rbt_node_release(RBTree *tree, RBNode *node) {
+    if (tree->pool) {
+        pool_free(tree->pool, node);
+    } else {
+        free(node);
+    }
+}
+
+/* Refill the filter from the tree's keys, sized with headroom to grow */
+static void rbt_bloom_rebuild(RBTree *tree) {
+    int n = rbt_size(tree->root);
+    if (!bloom_reset(tree->bloom, (size_t)n + (size_t)n / 2)) return;
+    
+    for (RBNode *node = rbt_find_min(tree->root); node; node = rbt_next(node)) {
+        bloom_add(tree->bloom, node->key);
+    }
+}
+
+/* After bulk restructuring: the filter no longer matches the keys */
+static void rbt_bloom_refresh(RBTree *tree) {
+    if (tree->bloom) rbt_bloom_rebuild(tree);
+}
+
+static void rbt_bloom_check(RBTree *tree) {
+    if (tree->bloom && bloom_stale(tree->bloom)) rbt_bloom_rebuild(tree);
+}
+
+/* Attach a blocked Bloom filter built from the current keys. Inserts and
+ * deletes keep it current. Returns 1 on success. */
+int rbt_enable_bloom(RBTree *tree, int bits_per_key) {
+    if (!tree) return 0;
+    if (!tree->bloom) {
+        tree->bloom = bloom_create(0, bits_per_key);
+        if (!tree->bloom) return 0;
+    }
+    rbt_bloom_rebuild(tree);
+    return 1;
+}
+
+/* A failed put (the table could not grow) would leave keys unreachable:
+ * drop the index and let lookups fall back to the descent */
+static void rbt_index_put(RBTree *tree, RBNode *node) {
+    if (tree->index && !hash_index_put(tree->index, node->key, node)) {
+        rbt_disable_hash_index(tree);
+    }
+}
+
+static void rbt_index_rebuild(RBTree *tree) {
+    if (!hash_index_reset(tree->index, (size_t)rbt_size(tree->root))) {
+        rbt_disable_hash_index(tree);
+        return;
+    }
+    for (RBNode *node = rbt_find_min(tree->root); node; node = rbt_next(node)) {
+        rbt_index_put(tree, node);
+    }
+}
+
+/* After bulk restructuring: rebuild from the tree's nodes */
+static void rbt_index_refresh(RBTree *tree) {
+    if (tree->index) rbt_index_rebuild(tree);
+}
+
+/* Remove the keys of a detached subtree (parent links may be stale) */
+static void rbt_index_drop(RBTree *tree, RBNode *node) {
+    if (!node) return;
+    rbt_index_drop(tree, node->left);
+    hash_index_remove(tree->index, node->key);
+    rbt_index_drop(tree, node->right);
+}
+
+/* Attach a hash index over the current nodes. Returns 1 on success. */
+int rbt_enable_hash_index(RBTree *tree) {
+    if (!tree) return 0;
+    if (!tree->index) {
+        tree->index = hash_index_create(0);
+        if (!tree->index) return 0;
+    }
+    rbt_index_rebuild(tree);
+    return tree->index != NULL;
+}
+
+void rbt_disable_hash_index(RBTree *tree) {
+    if (!tree) return;
+    hash_index_destroy(tree->index);
+    tree->index = NULL;
+}
+
 /* Enable/disable verbose output */
 void rbt_set_verbose(RBTree *tree, int enabled) {
     if (tree) tree->verbose = enabled;
@@ -67,6 +190,52 @@ RBNode* rbt_find_max(RBNode *node) {
     return node;
 }
 
+/* Subtree size (NIL = 0): stored in augmented nodes, counted otherwise */
+int rbt_size(RBNode *node) {
+    if (!node) return 0;
+    if (node->augmented) return RB_AUG(node)->size;
+    return 1 + rbt_size(node->left) + rbt_size(node->right);
+}
+
+/* Interval end: a plain node is the point [key, key] */
+int rbt_high(const RBNode *node) {
+    return node->augmented ? RB_AUG(node)->high : node->key;
+}
+
+/* Recompute a node's size and max endpoint from its children (nothing to
+ * do for a plain node) */
+static void rbt_update(RBNode *node) {
+    if (!node->augmented) return;
+    
+    RBAugNode *a = RB_AUG(node);
+    RBAugNode *l = RB_AUG(node->left);
+    RBAugNode *r = RB_AUG(node->right);
+    
+    a->size = 1 + (l ? l->size : 0) + (r ? r->size : 0);
+    a->max_high = a->high;
+    if (l && l->max_high > a->max_high) a->max_high = l->max_high;
+    if (r && r->max_high > a->max_high) a->max_high = r->max_high;
+}
+
+/* Refresh the augmentation from node up to the root; returns the number
+ * of nodes refreshed (0 in a plain tree) */
+static int rbt_update_up(RBNode *node) {
+    int refreshed = 0;
+    for (; node && node->augmented; node = node->parent) {
+        rbt_update(node);
+        refreshed++;
+    }
+    return refreshed;
+}
+
+/* After a rotation: y now roots the subtree x used to, and x sits below */
+static void rbt_update_rotated(RBNode *x, RBNode *y) {
+    if (!x->augmented) return;
+    RB_AUG(y)->size = RB_AUG(x)->size;
+    RB_AUG(y)->max_high = RB_AUG(x)->max_high;
+    rbt_update(x);
+}
+
 /* Get sibling of a node */
 static RBNode* rbt_get_sibling(RBNode *node) {
     if (!node || !node->parent) return NULL;
@@ -124,6 +293,8 @@ void rbt_left_rotate(RBTree *tree, RBNode *x) {
     y->left = x;
     x->parent = y;
     
+    rbt_update_rotated(x, y);
+    
     rbt_log(tree, "Left rotate at %d", x->key);
 }
 
@@ -160,6 +331,8 @@ void rbt_right_rotate(RBTree *tree, RBNode *x) {
     y->right = x;
     x->parent = y;
     
+    rbt_update_rotated(x, y);
+    
     rbt_log(tree, "Right rotate at %d", x->key);
 }
 
@@ -290,26 +463,68 @@ void rbt_insert_fixup(RBTree *tree, RBNode *z) {
     }
 }
 
-/* Insert a new key into the RB tree */
-RBNode* rbt_insert(RBTree *tree, int key) {
-    if (!tree) return NULL;
-    
-    /* Standard BST insert */
+/* Maximum node, recomputed only after something invalidated the cache */
+static RBNode* rbt_cached_max(RBTree *tree) {
+    if (!tree->max && tree->root) {
+        tree->max = rbt_find_max(tree->root);
+    }
+    return tree->max;
+}
+
+/* Climb from a node near the insertion point to the lowest ancestor whose
+ * subtree must contain the insertion point for key. Only one bound can be
+ * violated (the one on key's side of the hint), so only that one is checked
+ * at each step. Going left the bound is strict: an ancestor equal to key
+ * stays above the start of the descent, where multiset mode can meet it. */
+static RBNode* rbt_climb_for(RBNode *node, int key) {
+    if (key >= node->key) {
+        /* Going right: need an ancestor bounding the subtree from above */
+        while (node->parent) {
+            if (node == node->parent->left && key < node->parent->key) break;
+            node = node->parent;
+        }
+    } else {
+        /* Going left: need an ancestor bounding the subtree from below */
+        while (node->parent) {
+            if (node == node->parent->right && key > node->parent->key) break;
+            node = node->parent;
+        }
+    }
+    return node;
+}
+
+/* Standard BST insert of [key, high] starting at `start` (whose subtree
+ * must contain the insertion point; NULL for an empty tree), then fix-up.
+ * In multiset mode a point key met on the descent just gains a copy
+ * (NULL once its count is at RB_MAX_COUNT). */
+static RBNode* rbt_insert_from(RBTree *tree, RBNode *start, int key, int high) {
     RBNode *y = NULL;
-    RBNode *x = tree->root;
+    RBNode *x = start;
+    int bump = tree->multiset && key == high;
     
     while (x) {
+        if (bump && x->key == key && rbt_high(x) == key) {
+            if (x->count == RB_MAX_COUNT) {
+                rbt_log(tree, "Insert %d: count at its limit", key);
+                return NULL;
+            }
+            x->count++;
+            rbt_log(tree, "Insert %d: count now %d", key, x->count);
+            return x;
+        }
         y = x;
         x = (key < x->key) ? x->left : x->right;
     }
     
-    RBNode *z = rbt_node_create(key);
+    RBNode *z = rbt_node_create(tree, key);
     if (!z) return NULL;
     
+    if (z->augmented) RB_AUG(z)->high = RB_AUG(z)->max_high = high;
     z->parent = y;
     
     if (!y) {
         tree->root = z;
+        tree->max = z;
         rbt_log(tree, "Insert %d as root", key);
     } else if (key < y->key) {
         y->left = z;
@@ -321,20 +536,1194 @@ RBNode* rbt_insert(RBTree *tree, int key) {
                 key, y->key, rbt_color_string(z->color));
     }
     
+    if (tree->max && key >= tree->max->key) {
+        tree->max = z;
+    }
+    /* An augmented tree gains a node in every ancestor, so the refresh
+     * always reaches the root. A plain tree has nothing to refresh: the
+     * insert ends with the fix-up, O(1) amortized. */
+    tree->refreshed += rbt_update_up(y);
+    
     /* Fix-up violations */
     rbt_insert_fixup(tree, z);
     
+    rbt_index_put(tree, z);
+    if (tree->bloom) {
+        bloom_add(tree->bloom, key);
+        rbt_bloom_check(tree);
+    }
     return z;
 }
 
+/* Insert a new key into the RB tree (the point interval [key, key]) */
+RBNode* rbt_insert(RBTree *tree, int key) {
+    return rbt_insert_interval(tree, key, key);
+}
+
+/* Insert the interval [lo, hi], ordered by lo; NULL if hi < lo, or if
+ * hi > lo on a plain tree (it has nowhere to keep hi) */
+RBNode* rbt_insert_interval(RBTree *tree, int lo, int hi) {
+    if (!tree || hi < lo || (hi > lo && !tree->augmented)) return NULL;
+    
+    /* Monotonic append: the new key goes straight under the maximum, which
+     * never has a right child, so the search descent is skipped. A plain
+     * tree appends in O(1) amortized; an augmented one still refreshes
+     * size and max_high up to the root, O(log n) per key. */
+    RBNode *max = rbt_cached_max(tree);
+    if (max && lo >= max->key) {
+        rbt_log(tree, "Append fast path: %d >= current max %d", lo, max->key);
+        return rbt_insert_from(tree, max, lo, hi);
+    }
+    
+    return rbt_insert_from(tree, tree->root, lo, hi);
+}
+
+/* Insert starting from a node near the insertion point (e.g. the previously
+ * inserted node). The search costs O(log d) for a hint d keys away, which
+ * is the whole cost in a plain tree; in an augmented tree the size and
+ * max_high refresh above the new node keeps it at O(log n). A NULL hint is
+ * a plain rbt_insert. */
+RBNode* rbt_insert_hint(RBTree *tree, RBNode *hint, int key) {
+    if (!tree) return NULL;
+    if (!hint) return rbt_insert(tree, key);
+    
+    return rbt_insert_from(tree, rbt_climb_for(hint, key), key, key);
+}
+
+/* ============================================================================
+ * Delete with Fix-up
+ * ============================================================================
+ */
+
+static int rbt_is_black(RBNode *node) {
+    return !node || node->color == BLACK;
+}
+
+/* Delete Fix-up: Restore RB properties after removing a BLACK node
+ *
+ * x carries an extra BLACK ("double black"); parent is tracked separately
+ * because x may be NIL.
+ *
+ * Cases during fix-up (w = sibling of x):
+ * - Case 1: w is RED                         -> Rotate parent, recolor
+ * - Case 2: w BLACK, both children BLACK     -> Recolor w, move up
+ * - Case 3: w BLACK, near child RED          -> Rotate w to make line
+ * - Case 4: w BLACK, far child RED           -> Rotate parent, recolor, done
+ */
+static void rbt_delete_fixup(RBTree *tree, RBNode *x, RBNode *parent) {
+    while (x != tree->root && rbt_is_black(x)) {
+        if (x == parent->left) {
+            RBNode *w = parent->right;
+            
+            if (w->color == RED) {
+                /* Case 1: Sibling is RED */
+                rbt_log(tree, "Case 1 (Red sibling): Sibling %d RED, parent %d",
+                        w->key, parent->key);
+                rbt_log(tree, "  Recolor sibling %d to BLACK, parent %d to RED",
+                        w->key, parent->key);
+                rbt_log(tree, "  Left rotate at parent %d", parent->key);
+                
+                w->color = BLACK;
+                parent->color = RED;
+                rbt_left_rotate(tree, parent);
+                w = parent->right;
+            }
+            
+            if (rbt_is_black(w->left) && rbt_is_black(w->right)) {
+                /* Case 2: Sibling BLACK with BLACK children */
+                rbt_log(tree, "Case 2 (Recolor): Sibling %d BLACK with BLACK children",
+                        w->key);
+                rbt_log(tree, "  Recolor sibling %d to RED, move double black up to %d",
+                        w->key, parent->key);
+                
+                w->color = RED;
+                x = parent;
+                parent = x->parent;
+            } else {
+                if (rbt_is_black(w->right)) {
+                    /* Case 3: Near child RED (triangle) */
+                    rbt_log(tree, "Case 3 (Triangle): Sibling %d BLACK, near child %d RED",
+                            w->key, w->left->key);
+                    rbt_log(tree, "  Right rotate at sibling %d to make line", w->key);
+                    
+                    w->left->color = BLACK;
+                    w->color = RED;
+                    rbt_right_rotate(tree, w);
+                    w = parent->right;
+                }
+                
+                /* Case 4: Far child RED (line) */
+                rbt_log(tree, "Case 4 (Line): Sibling %d BLACK, far child %d RED",
+                        w->key, w->right->key);
+                rbt_log(tree, "  Sibling %d takes parent color %s, parent %d to BLACK",
+                        w->key, rbt_color_string(parent->color), parent->key);
+                rbt_log(tree, "  Left rotate at parent %d", parent->key);
+                
+                w->color = parent->color;
+                parent->color = BLACK;
+                w->right->color = BLACK;
+                rbt_left_rotate(tree, parent);
+                x = tree->root;
+            }
+        } else {
+            /* x is right child (mirror cases) */
+            RBNode *w = parent->left;
+            
+            if (w->color == RED) {
+                /* Case 1: Sibling is RED */
+                rbt_log(tree, "Case 1 (Red sibling): Sibling %d RED, parent %d (mirror)",
+                        w->key, parent->key);
+                rbt_log(tree, "  Recolor sibling %d to BLACK, parent %d to RED",
+                        w->key, parent->key);
+                rbt_log(tree, "  Right rotate at parent %d", parent->key);
+                
+                w->color = BLACK;
+                parent->color = RED;
+                rbt_right_rotate(tree, parent);
+                w = parent->left;
+            }
+            
+            if (rbt_is_black(w->left) && rbt_is_black(w->right)) {
+                /* Case 2: Sibling BLACK with BLACK children */
+                rbt_log(tree, "Case 2 (Recolor): Sibling %d BLACK with BLACK children (mirror)",
+                        w->key);
+                rbt_log(tree, "  Recolor sibling %d to RED, move double black up to %d",
+                        w->key, parent->key);
+                
+                w->color = RED;
+                x = parent;
+                parent = x->parent;
+            } else {
+                if (rbt_is_black(w->left)) {
+                    /* Case 3: Near child RED (triangle) */
+                    rbt_log(tree, "Case 3 (Triangle): Sibling %d BLACK, near child %d RED",
+                            w->key, w->right->key);
+                    rbt_log(tree, "  Left rotate at sibling %d to make line", w->key);
+                    
+                    w->right->color = BLACK;
+                    w->color = RED;
+                    rbt_left_rotate(tree, w);
+                    w = parent->left;
+                }
+                
+                /* Case 4: Far child RED (line) */
+                rbt_log(tree, "Case 4 (Line): Sibling %d BLACK, far child %d RED",
+                        w->key, w->left->key);
+                rbt_log(tree, "  Sibling %d takes parent color %s, parent %d to BLACK",
+                        w->key, rbt_color_string(parent->color), parent->key);
+                rbt_log(tree, "  Right rotate at parent %d", parent->key);
+                
+                w->color = parent->color;
+                parent->color = BLACK;
+                w->left->color = BLACK;
+                rbt_right_rotate(tree, parent);
+                x = tree->root;
+            }
+        }
+    }
+    
+    if (x && x->color != BLACK) {
+        rbt_log(tree, "Final: Recolor %d to BLACK", x->key);
+        x->color = BLACK;
+    }
+}
+
+/* Unlink a node without freeing it. A node with two children is replaced
+ * by its successor node (relinked, not key-copied), so other nodes never
+ * move. */
+static void rbt_unlink(RBTree *tree, RBNode *z) {
+    RBNode *y = z;
+    Color y_original_color = y->color;
+    RBNode *x;
+    RBNode *x_parent;
+    
+    /* The maximum has no right child: its predecessor takes over */
+    if (z == tree->max) {
+        tree->max = z->left ? rbt_find_max(z->left) : z->parent;
+    }
+    if (z == tree->finger) {
+        tree->finger = z->parent;
+    }
+    
+    if (!z->left) {
+        x = z->right;
+        x_parent = z->parent;
+        rbt_transplant(tree, z, z->right);
+    } else if (!z->right) {
+        x = z->left;
+        x_parent = z->parent;
+        rbt_transplant(tree, z, z->left);
+    } else {
+        y = rbt_find_min(z->right);
+        y_original_color = y->color;
+        x = y->right;
+        
+        rbt_log(tree, "  Node %d has two children, successor %d takes its place",
+                z->key, y->key);
+        
+        if (y->parent == z) {
+            x_parent = y;
+        } else {
+            x_parent = y->parent;
+            rbt_transplant(tree, y, y->right);
+            y->right = z->right;
+            y->right->parent = y;
+        }
+        rbt_transplant(tree, z, y);
+        y->left = z->left;
+        y->left->parent = y;
+        y->color = z->color;
+    }
+    
+    /* Every node from the physical removal point up lost a descendant.
+     * The fix-up's rotations keep the augmentation valid from here on. */
+    tree->refreshed += rbt_update_up(x_parent);
+    
+    if (y_original_color == BLACK) {
+        rbt_log(tree, "  Removed a BLACK node: fix double black");
+        rbt_delete_fixup(tree, x, x_parent);
+    }
+}
+
+/* Unlink and free a node */
+void rbt_delete_node(RBTree *tree, RBNode *z) {
+    if (!tree || !z) return;
+    
+    /* Duplicates sit next to each other in order: a remaining twin takes
+     * over the index entry */
+    if (tree->index && hash_index_get(tree->index, z->key) == z) {
+        RBNode *twin = rbt_prev(z);
+        if (!twin || twin->key != z->key) twin = rbt_next(z);
+        if (twin && twin->key == z->key) {
+            hash_index_put(tree->index, z->key, twin);
+        } else {
+            hash_index_remove(tree->index, z->key);
+        }
+    }
+    
+    rbt_unlink(tree, z);
+    rbt_node_release(tree, z);
+    if (tree->bloom) {
+        bloom_remove(tree->bloom, 1);
+        rbt_bloom_check(tree);
+    }
+}
+
+/* Delete a key from the RB tree; returns 1 if it was present */
+int rbt_delete(RBTree *tree, int key) {
+    if (!tree) return 0;
+    
+    RBNode *z = rbt_search(tree, key);
+    if (!z) {
+        rbt_log(tree, "Delete %d: not found", key);
+        return 0;
+    }
+    
+    if (tree->multiset && z->count > 1) {
+        z->count--;
+        rbt_log(tree, "Delete %d: count now %d", key, z->count);
+        return 1;
+    }
+    
+    rbt_log(tree, "Delete %d (color: %s)", key, rbt_color_string(z->color));
+    rbt_delete_node(tree, z);
+    return 1;
+}
+
+/* ============================================================================
+ * Bulk Build
+ * ============================================================================
+ */
+
+/* Shared, read-only state for one bulk build */
+typedef struct {
+    RBTree *tree;
+    const int *keys;
+    RBNode **slots;     /* Nodes preallocated in preorder, or NULL */
+    int red_depth;
+} RBBuild;
+
+typedef struct {
+    const RBBuild *build;
+    int lo, hi;
+    int pre;            /* Preorder index of this subtree's root */
+    int depth;
+    int spawn;          /* Fork-join levels still allowed */
+    RBNode *parent;
+    RBNode *out;
+} RBBuildTask;
+
+static RBNode* rbt_build_range(const RBBuild *b, int lo, int hi, int pre,
+                               RBNode *parent, int depth, int spawn);
+static void rbt_destroy_helper(RBTree *tree, RBNode *node);
+
+static void rbt_build_task(void *arg) {
+    RBBuildTask *t = (RBBuildTask *)arg;
+    t->out = rbt_build_range(t->build, t->lo, t->hi, t->pre,
+                             t->parent, t->depth, t->spawn);
+}
+
+/* Build keys[lo..hi] under parent. Splitting at the middle puts every NIL
+ * at depth red_depth or red_depth + 1, so coloring exactly the nodes on
+ * the deepest level RED gives equal black height with no RED-RED edge.
+ * Left subtree occupies preorder slots pre+1.., right starts after it.
+ * A non-empty range only comes back NULL when memory ran out; whatever
+ * was built below is released again, so no half-colored tree survives. */
+static RBNode* rbt_build_range(const RBBuild *b, int lo, int hi, int pre,
+                               RBNode *parent, int depth, int spawn) {
+    if (lo > hi) return NULL;
+    
+    int mid = lo + (hi - lo) / 2;
+    RBNode *node;
+    if (b->slots) {
+        node = b->slots[pre];
+        node->key = b->keys[mid];
+        if (node->augmented) RB_AUG(node)->high = node->key;
+    } else {
+        node = rbt_node_create(b->tree, b->keys[mid]);
+        if (!node) return NULL;
+    }
+    
+    node->parent = parent;
+    node->color = (depth == b->red_depth && depth > 0) ? RED : BLACK;
+    
+    int left_pre = pre + 1;
+    int right_pre = pre + 1 + (mid - lo);
+    if (spawn > 0 && hi - lo >= PAR_GRAIN) {
+        RBBuildTask left = { b, lo, mid - 1, left_pre, depth + 1, spawn - 1, node, NULL };
+        RBBuildTask right = { b, mid + 1, hi, right_pre, depth + 1, spawn - 1, node, NULL };
+        par_invoke(rbt_build_task, &left, rbt_build_task, &right);
+        node->left = left.out;
+        node->right = right.out;
+    } else {
+        node->left = rbt_build_range(b, lo, mid - 1, left_pre, node, depth + 1, 0);
+        node->right = rbt_build_range(b, mid + 1, hi, right_pre, node, depth + 1, 0);
+    }
+    
+    if ((lo < mid && !node->left) || (mid < hi && !node->right)) {
+        rbt_destroy_helper(b->tree, node->left);
+        rbt_destroy_helper(b->tree, node->right);
+        rbt_node_release(b->tree, node);
+        return NULL;
+    }
+    rbt_update(node);
+    return node;
+}
+
+/* Build a validated ascending array into an empty tree; 0 (tree still
+ * empty) if memory runs out */
+static int rbt_build_from(RBTree *tree, const int *keys, int n, int threads) {
+    int deepest = 0;
+    while ((2LL << deepest) - 1 < n) deepest++;  /* floor(log2(n)) */
+    
+    int spawn = threads > 1 ? par_spawn_depth(threads) : 0;
+    RBBuild build = { tree, keys, NULL, deepest };
+    
+    /* The pool is single-threaded: carve all nodes up front, in preorder,
+     * and let the build threads fill their own disjoint slots */
+    if (tree->pool && spawn > 0) {
+        build.slots = (RBNode **)malloc(sizeof(RBNode *) * (size_t)n);
+        if (!build.slots) return 0;
+        for (int i = 0; i < n; i++) {
+            build.slots[i] = rbt_node_create(tree, 0);
+            if (!build.slots[i]) {
+                while (i-- > 0) rbt_node_release(tree, build.slots[i]);
+                free(build.slots);
+                return 0;
+            }
+        }
+    }
+    
+    tree->root = rbt_build_range(&build, 0, n - 1, 0, NULL, 0, spawn);
+    free(build.slots);
+    if (n > 0 && !tree->root) return 0;
+    tree->max = NULL;
+    rbt_bloom_refresh(tree);
+    rbt_index_refresh(tree);
+    rbt_log(tree, "Bulk build: %d keys, deepest level %d colored RED", n, deepest);
+    return 1;
+}
+
+/* Fill an empty tree from strictly ascending keys in O(n).
+ * Returns 1 on success, 0 if the tree is not empty, keys are unsorted or
+ * memory runs out (the tree is then left empty). */
+int rbt_build_sorted(RBTree *tree, const int *keys, int n) {
+    if (!tree || tree->root || n < 0 || (n > 0 && !keys)) return 0;
+    for (int i = 1; i < n; i++) {
+        if (keys[i] <= keys[i - 1]) return 0;
+    }
+    return rbt_build_from(tree, keys, n, 1);
+}
+
+/* Fill an empty tree from unsorted keys: parallel radix sort + dedupe,
+ * then parallel build. Returns 1 on success. */
+int rbt_bulk_load(RBTree *tree, const int *keys, int n, int threads) {
+    if (!tree || tree->root) return 0;
+    
+    int *sorted;
+    int unique = bulk_sort_unique(keys, n, threads, &sorted);
+    if (unique < 0) return 0;
+    
+    int ok = rbt_build_from(tree, sorted, unique, par_threads(threads));
+    free(sorted);
+    return ok;
+}
+
+/* ============================================================================
+ * Split / Join
+ *
+ * join3(l, k, r) walks down the spine of the tree with the larger black
+ * height to a BLACK node whose black height matches the other tree, hangs
+ * k there as a RED node over both and lets the insert fix-up repair any
+ * RED-RED pair: O(|bh(l) - bh(r)| + 1). Split cuts along the search path
+ * and joins the pieces back; the join costs telescope to O(log n).
+ *
+ * Black height here counts BLACK nodes from a node down to NIL, including
+ * the node itself (NIL = 0).
+ * ============================================================================
+ */
+
+/* Black height of a valid subtree: every path agrees, so follow the left */
+static int rbt_black_height(RBNode *node) {
+    int bh = 0;
+    for (; node; node = node->left) {
+        if (node->color == BLACK) bh++;
+    }
+    return bh;
+}
+
+/* Make a subtree a stand-alone tree: no parent, BLACK root */
+static RBNode* rbt_detach(RBNode *node, int *bh) {
+    if (node) {
+        node->parent = NULL;
+        if (node->color == RED) {
+            node->color = BLACK;
+            (*bh)++;
+        }
+    }
+    return node;
+}
+
+/* Join l, k, r (keys of l <= k->key <= keys of r) into one tree whose root
+ * is returned with its black height in *bh. ctx supplies logging only. */
+static RBNode* rbt_join3(RBTree *ctx, RBNode *l, int bhl, RBNode *k,
+                         RBNode *r, int bhr, int *bh) {
+    l = rbt_detach(l, &bhl);
+    r = rbt_detach(r, &bhr);
+    
+    if (bhl == bhr) {
+        k->left = l;
+        k->right = r;
+        k->parent = NULL;
+        k->color = BLACK;
+        if (l) l->parent = k;
+        if (r) r->parent = k;
+        rbt_update(k);
+        *bh = bhl + 1;
+        rbt_log(ctx, "Join at %d: equal black heights %d, new BLACK root",
+                k->key, bhl);
+        return k;
+    }
+    
+    /* Walk the taller tree's inner spine: right spine of l, left spine of r */
+    int right_spine = bhl > bhr;
+    RBTree scratch = *ctx;
+    scratch.root = right_spine ? l : r;
+    int target = right_spine ? bhr : bhl;
+    int cur = right_spine ? bhl : bhr;
+    RBNode *parent = NULL;
+    RBNode *c = scratch.root;
+    
+    while (c && (cur > target || c->color == RED)) {
+        if (c->color == BLACK) cur--;
+        parent = c;
+        c = right_spine ? c->right : c->left;
+    }
+    
+    rbt_log(ctx, "Join at %d: black heights %d/%d, attach RED under %d",
+            k->key, bhl, bhr, parent->key);
+    k->color = RED;
+    k->parent = parent;
+    if (right_spine) {
+        parent->right = k;
+        k->left = c;
+        k->right = r;
+    } else {
+        parent->left = k;
+        k->left = l;
+        k->right = c;
+    }
+    if (k->left) k->left->parent = k;
+    if (k->right) k->right->parent = k;
+    rbt_update_up(k);
+    
+    rbt_insert_fixup(&scratch, k);
+    
+    /* The fix-up never moves the shorter tree off k, so its black height
+     * plus the BLACK nodes from k up to the root is the new height. Only
+     * the (short) path above k is walked. */
+    int height = target;
+    for (RBNode *x = k; x; x = x->parent) {
+        if (x->color == BLACK) height++;
+    }
+    *bh = height;
+    return scratch.root;
+}
+
+/* Split the subtree at node (black height bh) into keys < key and keys
+ * >= key (keys <= key and keys > key when inclusive). Every node on the
+ * search path is rejoined into one side. */
+static void rbt_split_at(RBTree *ctx, RBNode *node, int bh, int key, int inclusive,
+                         RBNode **l, int *bhl, RBNode **r, int *bhr) {
+    if (!node) {
+        *l = *r = NULL;
+        *bhl = *bhr = 0;
+        return;
+    }
+    
+    int child_bh = bh - (node->color == BLACK);
+    RBNode *a = node->left;
+    RBNode *b = node->right;
+    
+    if (inclusive ? key < node->key : key <= node->key) {
+        RBNode *mid;
+        int bh_mid;
+        rbt_split_at(ctx, a, child_bh, key, inclusive, l, bhl, &mid, &bh_mid);
+        *r = rbt_join3(ctx, mid, bh_mid, node, b, child_bh, bhr);
+    } else {
+        RBNode *mid;
+        int bh_mid;
+        rbt_split_at(ctx, b, child_bh, key, inclusive, &mid, &bh_mid, r, bhr);
+        *l = rbt_join3(ctx, a, child_bh, node, mid, bh_mid, bhl);
+    }
+}
+
+/* Move every key >= key from tree into the empty tree `right` in O(log n).
+ * Both trees must draw nodes from the same place: a pooled tree shares its
+ * pool with a plain (unpooled) empty `right`. Returns 1 on success. */
+int rbt_split(RBTree *tree, int key, RBTree *right) {
+    if (!tree || !right || right == tree || right->root) return 0;
+    if (right->augmented != tree->augmented) return 0;
+    if (right->pool != tree->pool) {
+        if (right->pool) return 0;
+        right->pool = pool_retain(tree->pool);
+    }
+    
+    RBNode *l, *r;
+    int bhl, bhr;
+    rbt_log(tree, "Split at %d", key);
+    rbt_split_at(tree, tree->root, rbt_black_height(tree->root), key, 0,
+                 &l, &bhl, &r, &bhr);
+    
+    tree->root = rbt_detach(l, &bhl);
+    right->root = rbt_detach(r, &bhr);
+    tree->max = NULL;
+    right->max = NULL;
+    tree->finger = NULL;
+    right->finger = NULL;
+    if (tree->bloom) {
+        bloom_remove(tree->bloom, (size_t)rbt_size(right->root));
+        rbt_bloom_check(tree);
+    }
+    rbt_bloom_refresh(right);
+    if (tree->index) rbt_index_drop(tree, right->root);
+    rbt_index_refresh(right);
+    return 1;
+}
+
+/* Append every node of `right` to `left` in O(log n) and leave `right`
+ * empty. Requires every key of right >= every key of left and the same
+ * node storage on both sides. Returns 1 on success. */
+int rbt_join(RBTree *left, RBTree *right) {
+    if (!left || !right || left == right || left->pool != right->pool ||
+        left->augmented != right->augmented) return 0;
+    if (!right->root) return 1;
+    
+    RBNode *k = rbt_find_min(right->root);
+    if (left->root && rbt_cached_max(left)->key > k->key) return 0;
+    
+    /* Left's filter and index take right's keys: O(|right|), not a full
+     * rebuild */
+    if (left->bloom || left->index) {
+        for (RBNode *n = k; n; n = rbt_next(n)) {
+            bloom_add(left->bloom, n->key);
+            rbt_index_put(left, n);
+        }
+    }
+    
+    if (left->root) {
+        rbt_unlink(right, k);
+        int bh;
+        rbt_log(left, "Join with separator %d", k->key);
+        left->root = rbt_join3(left, left->root, rbt_black_height(left->root), k,
+                               right->root, rbt_black_height(right->root), &bh);
+        left->max = right->root ? right->max : k;
+    } else {
+        left->root = right->root;
+        left->max = right->max;
+        left->finger = right->finger;
+    }
+    
+    right->root = NULL;
+    right->max = NULL;
+    right->finger = NULL;
+    rbt_bloom_check(left);
+    rbt_bloom_refresh(right);
+    rbt_index_refresh(right);
+    return 1;
+}
+
+/* ============================================================================
+ * Set Operations
+ *
+ * Divide and conquer on the root of a: split b around a->key, recurse on
+ * the two halves (in parallel near the top) and join the results with
+ * a's root or without it. Work O(m log(n/m + 1)) for sizes m <= n.
+ *
+ * Keys are treated as sets (inputs are expected to hold distinct keys).
+ * Dropped nodes are chained through ->right and released afterwards on the
+ * calling thread, since a node pool is single-threaded.
+ * ============================================================================
+ */
+
+typedef enum { RB_UNION, RB_INTERSECTION, RB_DIFFERENCE } RBSetOp;
+
+typedef struct {
+    RBTree *ctx;
+    RBSetOp op;
+    RBNode *a, *b;
+    int bha, bhb;
+    int spawn;          /* Fork-join levels still allowed */
+    RBNode *out;
+    int bh;
+    RBNode *dropped;    /* Chain of nodes to release, through ->right */
+    RBNode *dropped_tail;
+} RBSetTask;
+
+static void rbt_drop(RBSetTask *t, RBNode *node) {
+    node->right = t->dropped;
+    t->dropped = node;
+    if (!t->dropped_tail) t->dropped_tail = node;
+}
+
+static void rbt_drop_tree(RBSetTask *t, RBNode *node) {
+    if (!node) return;
+    rbt_drop_tree(t, node->left);
+    RBNode *right = node->right;
+    rbt_drop(t, node);
+    rbt_drop_tree(t, right);
+}
+
+static void rbt_drop_chain(RBSetTask *t, RBSetTask *from) {
+    if (!from->dropped) return;
+    from->dropped_tail->right = t->dropped;
+    t->dropped = from->dropped;
+    if (!t->dropped_tail) t->dropped_tail = from->dropped_tail;
+}
+
+/* Split into keys < key and keys > key; the node holding key (if any) is
+ * detached and returned */
+static RBNode* rbt_split3_at(RBTree *ctx, RBNode *node, int bh, int key,
+                             RBNode **l, int *bhl, RBNode **r, int *bhr) {
+    if (!node) {
+        *l = *r = NULL;
+        *bhl = *bhr = 0;
+        return NULL;
+    }
+    
+    int child_bh = bh - (node->color == BLACK);
+    RBNode *a = node->left;
+    RBNode *b = node->right;
+    RBNode *mid, *found;
+    int bh_mid;
+    
+    if (key == node->key) {
+        *l = rbt_detach(a, &child_bh);
+        *bhl = child_bh;
+        child_bh = bh - (node->color == BLACK);
+        *r = rbt_detach(b, &child_bh);
+        *bhr = child_bh;
+        return node;
+    }
+    if (key < node->key) {
+        found = rbt_split3_at(ctx, a, child_bh, key, l, bhl, &mid, &bh_mid);
+        *r = rbt_join3(ctx, mid, bh_mid, node, b, child_bh, bhr);
+    } else {
+        found = rbt_split3_at(ctx, b, child_bh, key, &mid, &bh_mid, r, bhr);
+        *l = rbt_join3(ctx, a, child_bh, node, mid, bh_mid, bhl);
+    }
+    return found;
+}
+
+/* Join two trees without a separator: the maximum of l becomes one */
+static RBNode* rbt_join2(RBTree *ctx, RBNode *l, int bhl, RBNode *r, int bhr,
+                         int *bh) {
+    if (!l || !r) {
+        *bh = l ? bhl : bhr;
+        return l ? l : r;
+    }
+    
+    RBTree scratch = *ctx;
+    scratch.root = l;
+    scratch.max = NULL;
+    scratch.finger = NULL;
+    RBNode *k = rbt_find_max(l);
+    rbt_unlink(&scratch, k);
+    return rbt_join3(ctx, scratch.root, rbt_black_height(scratch.root),
+                     k, r, bhr, bh);
+}
+
+static void rbt_set_op(RBSetTask *t);
+
+static void rbt_set_task(void *arg) {
+    rbt_set_op((RBSetTask *)arg);
+}
+
+static void rbt_set_op(RBSetTask *t) {
+    RBNode *a = t->a, *b = t->b;
+    int bha = t->bha, bhb = t->bhb;
+    
+    /* Union and intersection are symmetric: split the larger tree by the
+     * root of the smaller one */
+    if (t->op != RB_DIFFERENCE && bha > bhb) {
+        RBNode *tmp = a;
+        a = b;
+        b = tmp;
+        bha = t->bhb;
+        bhb = t->bha;
+    }
+    
+    if (!a || !b) {
+        t->out = NULL;
+        t->bh = 0;
+        if (t->op == RB_UNION || (t->op == RB_DIFFERENCE && a)) {
+            t->bh = a ? bha : bhb;
+            t->out = rbt_detach(a ? a : b, &t->bh);
+        } else {
+            rbt_drop_tree(t, a);
+            rbt_drop_tree(t, b);
+        }
+        return;
+    }
+    
+    RBNode *l2, *r2;
+    int bhl2, bhr2;
+    RBNode *found = rbt_split3_at(t->ctx, b, bhb, a->key, &l2, &bhl2, &r2, &bhr2);
+    int child_bh = bha - (a->color == BLACK);
+    
+    RBSetTask left = { t->ctx, t->op, a->left, l2, child_bh, bhl2,
+                       t->spawn - 1, NULL, 0, NULL, NULL };
+    RBSetTask right = { t->ctx, t->op, a->right, r2, child_bh, bhr2,
+                        t->spawn - 1, NULL, 0, NULL, NULL };
+    if (t->spawn > 0 && 2 * bha >= PAR_GRAIN_HEIGHT) {
+        par_invoke(rbt_set_task, &left, rbt_set_task, &right);
+    } else {
+        left.spawn = right.spawn = 0;
+        rbt_set_op(&left);
+        rbt_set_op(&right);
+    }
+    rbt_drop_chain(t, &left);
+    rbt_drop_chain(t, &right);
+    
+    int keep = t->op == RB_UNION || (t->op == RB_INTERSECTION) == (found != NULL);
+    if (found) rbt_drop(t, found);
+    if (keep) {
+        t->out = rbt_join3(t->ctx, left.out, left.bh, a, right.out, right.bh, &t->bh);
+    } else {
+        rbt_drop(t, a);
+        t->out = rbt_join2(t->ctx, left.out, left.bh, right.out, right.bh, &t->bh);
+    }
+}
+
+/* Replace dst with (dst op src) and leave src empty */
+static int rbt_set_apply(RBTree *dst, RBTree *src, RBSetOp op, int threads) {
+    if (!dst || !src || dst == src || dst->pool != src->pool ||
+        dst->augmented != src->augmented) return 0;
+    
+    RBSetTask t = { dst, op, dst->root, src->root,
+                    rbt_black_height(dst->root), rbt_black_height(src->root),
+                    par_spawn_depth(par_threads(threads)), NULL, 0, NULL, NULL };
+    rbt_set_op(&t);
+    
+    dst->root = rbt_detach(t.out, &t.bh);
+    dst->max = NULL;
+    dst->finger = NULL;
+    src->root = NULL;
+    src->max = NULL;
+    src->finger = NULL;
+    
+    while (t.dropped) {
+        RBNode *next = t.dropped->right;
+        rbt_node_release(dst, t.dropped);
+        t.dropped = next;
+    }
+    rbt_bloom_refresh(dst);
+    rbt_bloom_refresh(src);
+    rbt_index_refresh(dst);
+    rbt_index_refresh(src);
+    return 1;
+}
+
+/* dst = dst ∪ src, dst ∩ src or dst \ src, consuming src. Both trees must
+ * use the same node storage. Recursion runs on `threads` threads (<= 0:
+ * all cores). Returns 1 on success. */
+int rbt_union(RBTree *dst, RBTree *src, int threads) {
+    return rbt_set_apply(dst, src, RB_UNION, threads);
+}
+
+int rbt_intersection(RBTree *dst, RBTree *src, int threads) {
+    return rbt_set_apply(dst, src, RB_INTERSECTION, threads);
+}
+
+int rbt_difference(RBTree *dst, RBTree *src, int threads) {
+    return rbt_set_apply(dst, src, RB_DIFFERENCE, threads);
+}
+
+/* ============================================================================
+ * Range Queries
+ * ============================================================================
+ */
+
+static void rbt_destroy_helper(RBTree *tree, RBNode *node);
+
+/* Keys below key (or up to key when inclusive), summing left sizes */
+static int rbt_count_below(RBNode *node, int key, int inclusive) {
+    int count = 0;
+    while (node) {
+        if (key < node->key || (key == node->key && !inclusive)) {
+            node = node->left;
+        } else {
+            count += rbt_size(node->left) + 1;
+            node = node->right;
+        }
+    }
+    return count;
+}
+
+static int rbt_count_one(RBNode *node, void *arg) {
+    (void)node;
+    (void)arg;
+    return 1;
+}
+
+/* Number of keys in [lo, hi] (duplicates included): O(log n) from the
+ * sizes of an augmented tree, else O(log n + k) by walking the range */
+int rbt_range_count(RBTree *tree, int lo, int hi) {
+    if (!tree || lo > hi) return 0;
+    if (!tree->augmented) return rbt_visit_range(tree, lo, hi, rbt_count_one, NULL);
+    return rbt_count_below(tree->root, hi, 1) - rbt_count_below(tree->root, lo, 0);
+}
+
+/* Remove every key in [lo, hi] in O(log n + k): two splits cut the range
+ * out, its nodes are released, and one join rebalances what is left.
+ * Returns the number of keys removed. */
+int rbt_delete_range(RBTree *tree, int lo, int hi) {
+    if (!tree || !tree->root || lo > hi) return 0;
+    
+    RBNode *below, *rest, *mid, *above;
+    int bh_below, bh_rest, bh_mid, bh_above, bh;
+    rbt_split_at(tree, tree->root, rbt_black_height(tree->root), lo, 0,
+                 &below, &bh_below, &rest, &bh_rest);
+    rbt_split_at(tree, rest, bh_rest, hi, 1, &mid, &bh_mid, &above, &bh_above);
+    
+    int removed = rbt_size(mid);
+    rbt_log(tree, "Delete range [%d, %d]: %d keys", lo, hi, removed);
+    if (tree->index) rbt_index_drop(tree, mid);
+    rbt_destroy_helper(tree, mid);
+    
+    below = rbt_detach(below, &bh_below);
+    tree->root = rbt_detach(rbt_join2(tree, below, bh_below, above, bh_above, &bh), &bh);
+    tree->max = NULL;
+    tree->finger = NULL;
+    if (tree->bloom) {
+        bloom_remove(tree->bloom, (size_t)removed);
+        rbt_bloom_check(tree);
+    }
+    return removed;
+}
+
+/* ============================================================================
+ * Order Statistics
+ * ============================================================================
+ */
+
+/* Number of keys smaller than key (duplicates counted); -1 on a plain
+ * tree */
+int rbt_rank(RBTree *tree, int key) {
+    if (!tree) return 0;
+    if (!tree->augmented) return -1;
+    return rbt_count_below(tree->root, key, 0);
+}
+
+/* The k-th smallest node (k from 0), or NULL when k is out of range or
+ * the tree is plain */
+RBNode* rbt_select(RBTree *tree, int k) {
+    if (!tree || !tree->augmented || k < 0 || k >= rbt_size(tree->root)) return NULL;
+    
+    RBNode *node = tree->root;
+    while (node) {
+        int left = rbt_size(node->left);
+        if (k == left) {
+            break;
+        } else if (k < left) {
+            node = node->left;
+        } else {
+            k -= left + 1;
+            node = node->right;
+        }
+    }
+    return node;
+}
+
+/* Node at rank r mod n: uniform over the tree when r is a uniform draw */
+RBNode* rbt_sample(RBTree *tree, unsigned int r) {
+    if (!tree || !tree->root || !tree->augmented) return NULL;
+    return rbt_select(tree, (int)(r % (unsigned int)rbt_size(tree->root)));
+}
+
+/* ============================================================================
+ * Interval Queries
+ *
+ * Each node holds the interval [key, high] and max_high, the largest high
+ * in its subtree. [key, high] overlaps [lo, hi] iff key <= hi and
+ * high >= lo, so a subtree with max_high < lo holds no match and nothing
+ * right of a node with key > hi can match either. A plain tree holds only
+ * points, so its overlaps are the keys in [lo, hi].
+ * ============================================================================
+ */
+
+/* Some interval overlapping [lo, hi], or NULL, in O(log n). Going left
+ * whenever the left subtree reaches lo is safe: if it holds no overlap,
+ * the interval reaching lo starts after hi, and so does all of the right. */
+RBNode* rbt_interval_search(RBTree *tree, int lo, int hi) {
+    if (!tree || lo > hi) return NULL;
+    if (!tree->augmented) {
+        RBNode *node = rbt_ceil(tree, lo);
+        return node && node->key <= hi ? node : NULL;
+    }
+    
+    RBNode *node = tree->root;
+    while (node && (node->key > hi || RB_AUG(node)->high < lo)) {
+        if (node->left && RB_AUG(node->left)->max_high >= lo) {
+            node = node->left;
+        } else {
+            node = node->right;
+        }
+    }
+    return node;
+}
+
+/* In-order overlap walk; returns 0 once fn asked to stop */
+static int rbt_overlaps_in(RBNode *node, int lo, int hi, RBVisitFn fn,
+                           void *arg, int *visited) {
+    while (node && RB_AUG(node)->max_high >= lo) {
+        if (!rbt_overlaps_in(node->left, lo, hi, fn, arg, visited)) return 0;
+        if (node->key > hi) return 1;
+        if (RB_AUG(node)->high >= lo) {
+            (*visited)++;
+            if (!fn(node, arg)) return 0;
+        }
+        node = node->right;
+    }
+    return 1;
+}
+
+/* Call fn on every interval overlapping [lo, hi], in order of start, until
+ * it returns 0; returns the number of intervals visited. Only subtrees
+ * that can hold a match are entered. */
+int rbt_visit_overlaps(RBTree *tree, int lo, int hi, RBVisitFn fn, void *arg) {
+    int visited = 0;
+    if (!tree || !fn || lo > hi) return 0;
+    if (!tree->augmented) return rbt_visit_range(tree, lo, hi, fn, arg);
+    
+    rbt_overlaps_in(tree->root, lo, hi, fn, arg, &visited);
+    return visited;
+}
+
+/* ============================================================================
+ * Neighbour Queries
+ * ============================================================================
+ */
+
+/* One descent remembering the last node on the wanted side of key: the
+ * closest key below (or above) it, or key itself when inclusive */
+static RBNode* rbt_nearest(RBNode *node, int key, int below, int inclusive) {
+    RBNode *best = NULL;
+    while (node) {
+        if (node->key == key && inclusive) {
+            return node;
+        }
+        if (below ? node->key < key : node->key > key) {
+            best = node;
+            node = below ? node->right : node->left;
+        } else {
+            node = below ? node->left : node->right;
+        }
+    }
+    return best;
+}
+
+/* Largest key <= key */
+RBNode* rbt_floor(RBTree *tree, int key) {
+    return tree ? rbt_nearest(tree->root, key, 1, 1) : NULL;
+}
+
+/* Smallest key >= key */
+RBNode* rbt_ceil(RBTree *tree, int key) {
+    return tree ? rbt_nearest(tree->root, key, 0, 1) : NULL;
+}
+
+/* Largest key < key */
+RBNode* rbt_predecessor(RBTree *tree, int key) {
+    return tree ? rbt_nearest(tree->root, key, 1, 0) : NULL;
+}
+
+/* Smallest key > key */
+RBNode* rbt_successor(RBTree *tree, int key) {
+    return tree ? rbt_nearest(tree->root, key, 0, 0) : NULL;
+}
+
+/* In-order neighbours of a node through the parent links. A full walk
+ * crosses every edge twice, so each step is O(1) amortized. The subtree the
+ * following step will enter is prefetched. */
+RBNode* rbt_next(RBNode *node) {
+    if (!node) return NULL;
+    if (node->right) {
+        node = rbt_find_min(node->right);
+    } else {
+        while (node->parent && node == node->parent->right) {
+            node = node->parent;
+        }
+        node = node->parent;
+    }
+    if (node) TREE_PREFETCH(node->right);
+    return node;
+}
+
+RBNode* rbt_prev(RBNode *node) {
+    if (!node) return NULL;
+    if (node->left) {
+        node = rbt_find_max(node->left);
+    } else {
+        while (node->parent && node == node->parent->left) {
+            node = node->parent;
+        }
+        node = node->parent;
+    }
+    if (node) TREE_PREFETCH(node->left);
+    return node;
+}
+
+/* ============================================================================
+ * Cursor
+ *
+ * Parent links make the cursor a single node pointer: no path to keep, and
+ * nothing to release.
+ * ============================================================================
+ */
+
+void rbt_cursor_init(RBCursor *c, RBTree *tree) {
+    c->tree = tree;
+    c->node = NULL;
+}
+
+RBNode* rbt_cursor_first(RBCursor *c) {
+    c->node = c->tree ? rbt_find_min(c->tree->root) : NULL;
+    return c->node;
+}
+
+RBNode* rbt_cursor_last(RBCursor *c) {
+    c->node = c->tree ? rbt_find_max(c->tree->root) : NULL;
+    return c->node;
+}
+
+/* Leftmost node with a key >= key, so duplicates are visited from the first */
+RBNode* rbt_cursor_seek(RBCursor *c, int key) {
+    RBNode *node = c->tree ? c->tree->root : NULL;
+    RBNode *best = NULL;
+    
+    while (node) {
+        if (key <= node->key) {
+            best = node;
+            node = node->left;
+        } else {
+            node = node->right;
+        }
+    }
+    c->node = best;
+    return best;
+}
+
+RBNode* rbt_cursor_next(RBCursor *c) {
+    c->node = rbt_next(c->node);
+    return c->node;
+}
+
+RBNode* rbt_cursor_prev(RBCursor *c) {
+    c->node = rbt_prev(c->node);
+    return c->node;
+}
+
+/* Call fn on each key in [lo, hi] in order until it returns 0; returns the
+ * number of nodes visited */
+int rbt_visit_range(RBTree *tree, int lo, int hi, RBVisitFn fn, void *arg) {
+    RBCursor c;
+    int visited = 0;
+    
+    rbt_cursor_init(&c, tree);
+    for (RBNode *node = rbt_cursor_seek(&c, lo); node && node->key <= hi;
+         node = rbt_cursor_next(&c)) {
+        visited++;
+        if (!fn(node, arg)) {
+            break;
+        }
+    }
+    return visited;
+}
+
 /* ============================================================================
  * Search
  * ============================================================================
  */
 
-/* Search for a key in the tree */
+int rbt_set_multiset(RBTree *tree, int enabled) {
+    if (!tree || tree->root) return 0;
+    tree->multiset = enabled != 0;
+    return 1;
+}
+
+/* A pooled tree swaps its pool for one sized to the new node type */
+int rbt_set_augmented(RBTree *tree, int enabled) {
+    if (!tree || tree->root) return 0;
+    enabled = enabled != 0;
+    if (tree->pool && enabled != tree->augmented) {
+        if (pool_owners(tree->pool) > 1) return 0;
+        NodePool *pool = pool_create(enabled ? sizeof(RBAugNode) : sizeof(RBNode),
+                                     pool_slab_nodes(tree->pool));
+        if (!pool) return 0;
+        pool_destroy(tree->pool);
+        tree->pool = pool;
+    }
+    tree->augmented = enabled;
+    return 1;
+}
+
+/* Copies of key: one node's count in multiset mode, else its nodes */
+int rbt_count(RBTree *tree, int key) {
+    if (!tree) return 0;
+    if (!tree->multiset) return rbt_range_count(tree, key, key);
+    
+    RBNode *node = rbt_search(tree, key);
+    return node ? node->count : 0;
+}
+
+/* Search for a key in the tree. A hash index answers directly; with a
+ * Bloom filter attached most misses are rejected by one cache-line probe
+ * before the descent. */
 RBNode* rbt_search(RBTree *tree, int key) {
     if (!tree) return NULL;
+    if (tree->index) return (RBNode *)hash_index_get(tree->index, key);
+    if (tree->bloom && !bloom_may_contain(tree->bloom, key)) return NULL;
     
     RBNode *node = tree->root;
     while (node) {
@@ -349,6 +1738,94 @@ RBNode* rbt_search(RBTree *tree, int key) {
     return NULL;
 }
 
+/* Interleaved lookups (see prefetch.h): out[i] = rbt_search(tree, keys[i]).
+ * Returns the number of keys found. */
+int rbt_search_batch(RBTree *tree, const int *keys, int n, RBNode **out) {
+    if (!tree) return 0;
+    
+    if (tree->index) {
+        int found = 0;
+        for (int i = 0; i < n; i++) {
+            out[i] = (RBNode *)hash_index_get(tree->index, keys[i]);
+            if (out[i]) found++;
+        }
+        return found;
+    }
+    
+    RBNode *root = tree->root;
+    RBNode *cur[TREE_BATCH_WINDOW];
+    int idx[TREE_BATCH_WINDOW];
+    int next = 0, active = 0, found = 0;
+    
+    for (; active < TREE_BATCH_WINDOW && next < n; active++) {
+        idx[active] = next++;
+        cur[active] = root;
+    }
+    
+    while (active > 0) {
+        for (int s = 0; s < active; ) {
+            RBNode *node = cur[s];
+            int key = keys[idx[s]];
+            if (node && node->key != key) {
+                node = (key < node->key) ? node->left : node->right;
+                TREE_PREFETCH(node);
+                cur[s++] = node;
+                continue;
+            }
+            
+            /* Finished: record, then refill the slot or close the gap */
+            out[idx[s]] = node;
+            if (node) found++;
+            if (next < n) {
+                idx[s] = next++;
+                cur[s++] = root;
+            } else {
+                active--;
+                idx[s] = idx[active];
+                cur[s] = cur[active];
+            }
+        }
+    }
+    return found;
+}
+
+/* Climb from the finger to the lowest ancestor whose subtree can hold key.
+ * Moving away from the finger, only the bound on key's side can fail, and
+ * the climb stops at the first ancestor that satisfies it (or holds key). */
+static RBNode* rbt_finger_climb(RBNode *node, int key) {
+    int go_right = key > node->key;
+    
+    while (node->parent && node->key != key) {
+        RBNode *p = node->parent;
+        if (go_right ? (node == p->left && key < p->key)
+                     : (node == p->right && key > p->key)) {
+            break;
+        }
+        node = p;
+    }
+    return node;
+}
+
+/* Finger search: start from the last accessed node instead of the root.
+ * Consecutive lookups d keys apart cost O(log d). The node where the search
+ * ends (hit or the last node probed on a miss) becomes the new finger. */
+RBNode* rbt_finger_search(RBTree *tree, int key) {
+    if (!tree || !tree->root) return NULL;
+    
+    RBNode *node = tree->finger ? rbt_finger_climb(tree->finger, key) : tree->root;
+    RBNode *last = node;
+    while (node) {
+        last = node;
+        if (key == node->key) {
+            break;
+        }
+        node = (key < node->key) ? node->left : node->right;
+    }
+    
+    tree->finger = last;
+    return node;
+}
+
 /* ============================================================================
  * Tree Traversal & Utility
  * ============================================================================
@@ -373,23 +1850,34 @@ void rbt_inorder(RBTree *tree) {
 }
 
 /* Helper for tree destruction */
-static void rbt_destroy_helper(RBNode *node) {
+static void rbt_destroy_helper(RBTree *tree, RBNode *node) {
     if (!node) return;
     
-    rbt_destroy_helper(node->left);
-    rbt_destroy_helper(node->right);
-    free(node);
+    rbt_destroy_helper(tree, node->left);
+    rbt_destroy_helper(tree, node->right);
+    rbt_node_release(tree, node);
 }
 
 /* Destroy tree and free memory */
 void rbt_destroy(RBTree *tree) {
     if (!tree) return;
     
-    rbt_destroy_helper(tree->root);
+    /* Pooled trees drop whole slabs instead of walking every node, unless
+     * the pool is still shared with a split/join partner */
+    if (tree->pool) {
+        if (pool_owners(tree->pool) > 1) {
+            rbt_destroy_helper(tree, tree->root);
+        }
+        pool_destroy(tree->pool);
+    } else {
+        rbt_destroy_helper(tree, tree->root);
+    }
+    bloom_destroy(tree->bloom);
+    hash_index_destroy(tree->index);
     free(tree);
 }
 
-/* Transplant (used in delete, included for completeness) */
+/* Transplant: Replace subtree u with subtree v (used in delete) */
 void rbt_transplant(RBTree *tree, RBNode *u, RBNode *v) {
     if (!tree || !u) return;
     
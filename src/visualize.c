@@ -11,23 +11,24 @@ static void print_bst_recursive(BSTNode *node, int level, int max_level);
 static void print_avl_recursive(AVLNode *node, int level, int max_level);
 static void print_rbt_recursive(RBNode *node, int level, int max_level);
 
-/* Helper: Calculate tree height */
+/* Helpers: tree height in edges (leaf = 0, empty = -1), the convention
+ * avl_height and the per-node "h:" labels use */
 int tree_height(BSTNode* node) {
-    if (!node) return 0;
+    if (!node) return -1;
     int left_h = tree_height(node->left);
     int right_h = tree_height(node->right);
     return (left_h > right_h ? left_h : right_h) + 1;
 }
 
 int tree_height_avl(AVLNode* node) {
-    if (!node) return 0;
+    if (!node) return -1;
     int left_h = tree_height_avl(node->left);
     int right_h = tree_height_avl(node->right);
     return (left_h > right_h ? left_h : right_h) + 1;
 }
 
 int tree_height_rbt(RBNode* node) {
-    if (!node) return 0;
+    if (!node) return -1;
     int left_h = tree_height_rbt(node->left);
     int right_h = tree_height_rbt(node->right);
     return (left_h > right_h ? left_h : right_h) + 1;
@@ -74,8 +75,8 @@ void print_bst(BSTNode* root) {
     printf("  BST Structure (Level-wise):\n");
     printf("  ============================\n");
     
-    int h = tree_height(root);
-    print_bst_recursive(root, 1, h);
+    int levels = tree_height(root) + 1;
+    print_bst_recursive(root, 1, levels);
     printf("\n");
 }
 
@@ -135,8 +136,8 @@ void print_avl(AVLNode* root) {
     printf("  AVL Structure (Level-wise):\n");
     printf("  ============================\n");
     
-    int h = tree_height_avl(root);
-    print_avl_recursive(root, 1, h);
+    int levels = tree_height_avl(root) + 1;
+    print_avl_recursive(root, 1, levels);
     printf("\n");
 }
 
@@ -159,7 +160,7 @@ void print_avl_detailed(AVLNode* root) {
     printf("\n");
     
     printf("  Height: %d\n", tree_height_avl(root));
-    printf("  (h:balance factor shown in nodes)\n");
+    printf("  (h: node height in edges, leaf = 0)\n");
     printf("\n");
 }
 
@@ -202,8 +203,8 @@ void print_rbt(RBNode* root) {
     printf("  ============================\n");
     printf("  (R=RED, B=BLACK)\n");
     
-    int h = tree_height_rbt(root);
-    print_rbt_recursive(root, 1, h);
+    int levels = tree_height_rbt(root) + 1;
+    print_rbt_recursive(root, 1, levels);
     printf("\n");
 }
 
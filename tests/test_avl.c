@@ -10,6 +10,7 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <limits.h>
+#include <stdint.h>
 #include "../include/avl.h"
 
 /* ============================================================================
@@ -63,6 +64,66 @@ static int count_nodes(AVLNode* root) {
     return 1 + count_nodes(root->left) + count_nodes(root->right);
 }
 
+/**
+ * @brief Verify stored heights and (kept) live subtree sizes match the
+ * real ones
+ * Returns the height, or INT_MIN on mismatch
+ */
+static int verify_heights(AVLNode* node) {
+    if (!node) return -1;
+    
+    int hl = verify_heights(node->left);
+    int hr = verify_heights(node->right);
+    if (hl == INT_MIN || hr == INT_MIN) return INT_MIN;
+    
+    int h = 1 + (hl > hr ? hl : hr);
+    if (node->height != h) {
+        printf("ERROR: Node %d stores height %d, actual %d\n", node->key, node->height, h);
+        return INT_MIN;
+    }
+    if (node->sized && node->size != !node->dead + avl_size(node->left) + avl_size(node->right)) {
+        printf("ERROR: Node %d stores size %d\n", node->key, node->size);
+        return INT_MIN;
+    }
+    return h;
+}
+
+/**
+ * @brief No node keeps a size, and none was touched since it was created
+ */
+static int sizes_untouched(AVLNode* node) {
+    if (!node) return 1;
+    if (node->sized || node->size != 1) return 0;
+    return sizes_untouched(node->left) && sizes_untouched(node->right);
+}
+
+/**
+ * @brief Nodes sit at strictly rising addresses in preorder, i.e. they
+ * were carved one after another out of a single slab
+ */
+static int laid_out_in_preorder(AVLNode* node, uintptr_t* last) {
+    if (!node) return 1;
+    if ((uintptr_t)node <= *last) return 0;
+    *last = (uintptr_t)node;
+    return laid_out_in_preorder(node->left, last) &&
+           laid_out_in_preorder(node->right, last);
+}
+
+/**
+ * @brief Range visitor: records keys, stops after `limit` of them
+ */
+typedef struct {
+    int keys[64];
+    int count;
+    int limit;
+} VisitLog;
+
+static int record_key(AVLNode* node, void* arg) {
+    VisitLog* log = arg;
+    log->keys[log->count++] = node->key;
+    return log->count < log->limit;
+}
+
 /* ============================================================================
  * Test Cases
  * ============================================================================
@@ -304,6 +365,783 @@ int test_avl_empty_operations(void) {
     return 1;
 }
 
+/**
+ * @test test_avl_pooled_tree
+ * @brief Pooled tree stays balanced and recycles freed nodes
+ */
+int test_avl_pooled_tree(void) {
+    printf("Test: Pooled tree insert/delete... ");
+    AVLTree* tree = avl_create_pooled(8);
+    assert(tree != NULL);
+    
+    for (int i = 1; i <= 32; i++) {
+        avl_tree_insert(tree, i);
+    }
+    assert(count_nodes(tree->root) == 32);
+    assert(verify_balance(tree->root));
+    size_t slabs = pool_slab_count(tree->pool);
+    
+    for (int i = 1; i <= 32; i += 2) {
+        avl_tree_delete(tree, i);
+    }
+    assert(pool_live(tree->pool) == 16);
+    assert(verify_balance(tree->root));
+    
+    for (int i = 1; i <= 32; i += 2) {
+        avl_tree_insert(tree, i);
+    }
+    assert(pool_live(tree->pool) == 32);
+    assert(pool_slab_count(tree->pool) == slabs);
+    
+    avl_destroy(tree);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_avl_large_churn
+ * @brief Many inserts/deletes keep heights exact and the tree balanced
+ */
+int test_avl_large_churn(void) {
+    printf("Test: Large insert/delete churn... ");
+    AVLNode* root = NULL;
+    const int n = 4096;
+    
+    for (int i = 0; i < n; i++) {
+        root = avl_insert(root, (i * 2654435761u) % 10007);
+    }
+    assert(verify_heights(root) != INT_MIN);
+    assert(verify_balance(root));
+    assert(avl_height(root) <= 17);  /* 1.44 * log2(4096) */
+    
+    for (int i = 0; i < n; i += 3) {
+        root = avl_delete(root, (i * 2654435761u) % 10007);
+        assert(avl_search(root, (i * 2654435761u) % 10007) == NULL);
+    }
+    assert(verify_heights(root) != INT_MIN);
+    assert(verify_balance(root));
+    
+    int* inorder = malloc(sizeof(int) * n);
+    int idx = 0;
+    avl_inorder_to_array(root, inorder, &idx);
+    assert(is_sorted(inorder, idx));
+    assert(idx == count_nodes(root));
+    free(inorder);
+    
+    avl_free(root);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_avl_build_sorted
+ * @brief Bulk build sets exact heights without rotations
+ */
+int test_avl_build_sorted(void) {
+    printf("Test: Build from sorted array... ");
+    
+    for (int n = 1; n <= 130; n++) {
+        int* keys = malloc(sizeof(int) * n);
+        for (int i = 0; i < n; i++) keys[i] = i - 50;
+        
+        AVLNode* root = avl_build_sorted(keys, n);
+        assert(count_nodes(root) == n);
+        assert(verify_heights(root) != INT_MIN);
+        assert(verify_balance(root));
+        
+        /* Still a normal AVL afterwards */
+        root = avl_insert(root, 1000);
+        root = avl_delete(root, keys[0]);
+        assert(verify_heights(root) != INT_MIN);
+        assert(verify_balance(root));
+        
+        avl_free(root);
+        free(keys);
+    }
+    
+    int dup[] = {1, 1, 2};
+    assert(avl_build_sorted(dup, 3) == NULL);
+    
+    /* Tree handle: nodes come from the pool in preorder */
+    int keys[500];
+    for (int i = 0; i < 500; i++) keys[i] = i * 2;
+    AVLTree* tree = avl_create_pooled(500);
+    uintptr_t last = 0;
+    assert(!avl_tree_build_sorted(tree, dup, 3) && tree->root == NULL);
+    assert(avl_tree_build_sorted(tree, keys, 500));
+    assert(verify_heights(tree->root) != INT_MIN && verify_balance(tree->root));
+    assert(laid_out_in_preorder(tree->root, &last));
+    assert(avl_size(tree->root) == 500 && pool_live(tree->pool) == 500);
+    assert(!avl_tree_build_sorted(tree, keys, 500));    /* not empty */
+    avl_destroy(tree);
+    
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_avl_bulk_load
+ * @brief Parallel bulk load yields a valid AVL over the unique keys
+ */
+int test_avl_bulk_load(void) {
+    printf("Test: Parallel bulk load from unsorted keys... ");
+    const int n = 100000;
+    int* keys = malloc(sizeof(int) * n);
+    for (int i = 0; i < n; i++) {
+        keys[i] = (int)((i * 2654435761u) % 70001) - 35000;
+    }
+    
+    AVLNode* root = avl_bulk_load(keys, n, 0);
+    assert(verify_heights(root) != INT_MIN);
+    assert(verify_balance(root));
+    
+    int* inorder = malloc(sizeof(int) * n);
+    int idx = 0;
+    avl_inorder_to_array(root, inorder, &idx);
+    assert(idx == count_nodes(root));
+    for (int i = 1; i < idx; i++) {
+        assert(inorder[i] > inorder[i - 1]);  /* strictly: duplicates dropped */
+    }
+    
+    /* Pooled: the threads fill nodes carved up front in preorder */
+    AVLTree* tree = avl_create_pooled((size_t)idx);
+    uintptr_t last = 0;
+    assert(avl_tree_bulk_load(tree, keys, n, 4));
+    assert(verify_heights(tree->root) != INT_MIN);
+    assert(laid_out_in_preorder(tree->root, &last));
+    assert(avl_size(tree->root) == idx && pool_live(tree->pool) == (size_t)idx);
+    avl_destroy(tree);
+    
+    avl_free(root);
+    free(inorder);
+    free(keys);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_avl_split_join
+ * @brief Split at many keys gives two valid AVLs that join back to the original
+ */
+int test_avl_split_join(void) {
+    printf("Test: Split and join... ");
+    const int n = 2000;
+    AVLNode* root = NULL;
+    for (int i = 0; i < n; i++) {
+        root = avl_insert(root, (i * 7919) % n * 2);  /* even keys 0..2n-2 */
+    }
+    
+    int cuts[] = {-5, 0, 1, 777, 1000, 2001, 3998, 3999, 5000};
+    for (int c = 0; c < 9; c++) {
+        AVLNode *left, *right;
+        avl_split(root, cuts[c], &left, &right);
+        assert(verify_heights(left) != INT_MIN && verify_balance(left));
+        assert(verify_heights(right) != INT_MIN && verify_balance(right));
+        
+        int expect_left = cuts[c] <= 0 ? 0 : (cuts[c] + 1) / 2;
+        if (expect_left > n) expect_left = n;
+        assert(count_nodes(left) == expect_left);
+        assert(count_nodes(right) == n - expect_left);
+        if (left) assert(avl_search(left, cuts[c]) == NULL);
+        
+        root = avl_join(left, right);
+        assert(verify_heights(root) != INT_MIN && verify_balance(root));
+        assert(count_nodes(root) == n);
+    }
+    
+    /* Joining trees of very different heights */
+    AVLNode* small = NULL;
+    for (int i = 0; i < 3; i++) small = avl_insert(small, 10000 + i);
+    root = avl_join(root, small);
+    assert(verify_heights(root) != INT_MIN && verify_balance(root));
+    
+    int* inorder = malloc(sizeof(int) * (n + 3));
+    int idx = 0;
+    avl_inorder_to_array(root, inorder, &idx);
+    assert(idx == n + 3 && is_sorted(inorder, idx));
+    
+    free(inorder);
+    avl_free(root);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_avl_set_operations
+ * @brief Union, intersection and difference match a brute-force merge
+ */
+int test_avl_set_operations(void) {
+    printf("Test: Parallel set operations... ");
+    const int n = 20000;
+    int* expect = malloc(sizeof(int) * 3 * n);
+    int* inorder = malloc(sizeof(int) * 3 * n);
+    
+    for (int op = 0; op < 3; op++) {
+        for (int threads = 1; threads <= 4; threads += 3) {
+            /* a: multiples of 2, b: multiples of 3 (small delta or large) */
+            int nb = threads == 1 ? 50 : n;
+            AVLNode *a = NULL, *b = NULL;
+            for (int i = 0; i < n; i++) a = avl_insert(a, i * 2);
+            for (int i = 0; i < nb; i++) b = avl_insert(b, i * 3);
+            
+            int count = 0;
+            for (int k = 0; k < 3 * n; k++) {
+                int in_a = k % 2 == 0 && k < 2 * n;
+                int in_b = k % 3 == 0 && k < 3 * nb;
+                if (op == 0 ? (in_a || in_b) : op == 1 ? (in_a && in_b) : (in_a && !in_b))
+                    expect[count++] = k;
+            }
+            
+            AVLNode* r = op == 0 ? avl_union(a, b, threads)
+                       : op == 1 ? avl_intersection(a, b, threads)
+                                 : avl_difference(a, b, threads);
+            assert(verify_heights(r) != INT_MIN && verify_balance(r));
+            
+            int idx = 0;
+            avl_inorder_to_array(r, inorder, &idx);
+            assert(idx == count);
+            for (int i = 0; i < count; i++) assert(inorder[i] == expect[i]);
+            avl_free(r);
+        }
+    }
+    
+    assert(avl_union(NULL, NULL, 0) == NULL);
+    assert(avl_intersection(avl_insert(NULL, 1), NULL, 0) == NULL);
+    
+    free(expect);
+    free(inorder);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_avl_range_queries
+ * @brief Range count matches a scan; range delete keeps the tree valid
+ */
+int test_avl_range_queries(void) {
+    printf("Test: Range count and range delete... ");
+    AVLTree* tree = avl_create_pooled(0);
+    avl_set_sized(tree, 1);
+    for (int i = 0; i < 5000; i++) {
+        avl_tree_insert(tree, (i * 7919) % 5000 * 2);  /* even keys 0..9998 */
+    }
+    assert(verify_heights(tree->root) != INT_MIN);
+    
+    assert(avl_range_count(tree->root, 0, 9998) == 5000);
+    assert(avl_range_count(tree->root, 1, 1) == 0);
+    assert(avl_range_count(tree->root, 10, 20) == 6);
+    assert(avl_range_count(tree->root, 11, 19) == 4);
+    assert(avl_range_count(tree->root, INT_MIN, INT_MAX) == 5000);
+    assert(avl_range_count(tree->root, 20, 10) == 0);
+    
+    assert(avl_tree_delete_range(tree, 1001, 2999) == 999);
+    assert(verify_heights(tree->root) != INT_MIN && verify_balance(tree->root));
+    assert(avl_search(tree->root, 1000) && avl_search(tree->root, 3000));
+    assert(!avl_search(tree->root, 2000));
+    assert(avl_range_count(tree->root, INT_MIN, INT_MAX) == 4001);
+    assert(count_nodes(tree->root) == 4001);
+    
+    assert(avl_tree_delete_range(tree, 4000, 4000) == 1);
+    assert(avl_tree_delete_range(tree, 2000, 2998) == 0);
+    assert(avl_tree_delete_range(tree, INT_MIN, 500) == 251);
+    assert(avl_tree_delete_range(tree, 9000, INT_MAX) == 500);
+    assert(verify_heights(tree->root) != INT_MIN && verify_balance(tree->root));
+    assert(count_nodes(tree->root) == 3249);
+    assert(pool_live(tree->pool) == 3249);
+    
+    assert(avl_tree_delete_range(tree, INT_MIN, INT_MAX) == 3249);
+    assert(tree->root == NULL);
+    
+    avl_destroy(tree);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_avl_order_statistics
+ * @brief rank/select agree with the sorted order; sampling covers every key
+ */
+int test_avl_order_statistics(void) {
+    printf("Test: Rank, select and sampling... ");
+    const int n = 4000;
+    AVLNode* root = NULL;
+    for (int i = 0; i < n; i++) {
+        root = avl_insert(root, (i * 7919) % n * 3);  /* multiples of 3 */
+    }
+    for (int i = 0; i < n; i += 2) {
+        root = avl_delete(root, i * 3);               /* odd multiples left */
+    }
+    
+    int live = n / 2;
+    for (int k = 0; k < live; k++) {
+        int key = (2 * k + 1) * 3;
+        assert(avl_select(root, k)->key == key);
+        assert(avl_rank(root, key) == k);
+        assert(avl_rank(root, key + 1) == k + 1);
+    }
+    assert(avl_select(root, -1) == NULL && avl_select(root, live) == NULL);
+    assert(avl_rank(root, INT_MIN) == 0 && avl_rank(root, INT_MAX) == live);
+    
+    /* Median and 99th percentile */
+    assert(avl_select(root, live / 2)->key == (2 * (live / 2) + 1) * 3);
+    assert(avl_select(root, live * 99 / 100)->key == (2 * (live * 99 / 100) + 1) * 3);
+    
+    int hits[8] = {0};
+    AVLNode* small = NULL;
+    for (int i = 0; i < 8; i++) small = avl_insert(small, i);
+    srand(42);
+    for (int i = 0; i < 80000; i++) hits[avl_sample(small, (unsigned int)rand())->key]++;
+    for (int i = 0; i < 8; i++) assert(hits[i] > 9000 && hits[i] < 11000);
+    assert(avl_sample(NULL, 7) == NULL);
+    
+    avl_free(small);
+    avl_free(root);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_avl_neighbours
+ * @brief floor/ceil/predecessor/successor match a brute-force scan
+ */
+int test_avl_neighbours(void) {
+    printf("Test: Floor, ceil, predecessor, successor... ");
+    AVLNode* root = NULL;
+    for (int i = 0; i < 100; i++) {
+        root = avl_insert(root, (i * 37) % 100 * 10);
+    }
+    
+    /* Keys are multiples of 10 in [0, 990] */
+    for (int q = -15; q <= 1005; q++) {
+        int fl = q < 0 ? -1 : (q > 990 ? 990 : q / 10 * 10);
+        int ce = q > 990 ? -1 : (q <= 0 ? 0 : (q + 9) / 10 * 10);
+        int pr = q <= 0 ? -1 : (q > 990 ? 990 : (q - 1) / 10 * 10);
+        int su = q >= 990 ? -1 : (q < 0 ? 0 : q / 10 * 10 + 10);
+        
+        AVLNode* n = avl_floor(root, q);
+        assert(fl < 0 ? n == NULL : n->key == fl);
+        n = avl_ceil(root, q);
+        assert(ce < 0 ? n == NULL : n->key == ce);
+        n = avl_predecessor(root, q);
+        assert(pr < 0 ? n == NULL : n->key == pr);
+        n = avl_successor(root, q);
+        assert(su < 0 ? n == NULL : n->key == su);
+    }
+    
+    avl_free(root);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_avl_cursor
+ * @brief Cursor walks both ways, seeks to the ceiling, and bounded visits
+ * stop early
+ */
+int test_avl_cursor(void) {
+    printf("Test: Cursor and range visit... ");
+    AVLNode* root = NULL;
+    for (int i = 0; i < 100; i++) root = avl_insert(root, (i * 37) % 100 * 10);
+    
+    AVLCursor c;
+    avl_cursor_init(&c, root);
+    AVLNode* node = avl_cursor_first(&c);
+    for (int k = 0; k < 100; k++, node = avl_cursor_next(&c)) assert(node->key == k * 10);
+    assert(node == NULL);
+    node = avl_cursor_last(&c);
+    for (int k = 99; k >= 0; k--, node = avl_cursor_prev(&c)) assert(node->key == k * 10);
+    assert(node == NULL);
+    
+    assert(avl_cursor_seek(&c, 455)->key == 460);
+    assert(avl_cursor_prev(&c)->key == 450);
+    assert(avl_cursor_seek(&c, 460)->key == 460);
+    assert(avl_cursor_next(&c)->key == 470);
+    assert(avl_cursor_seek(&c, 991) == NULL);
+    assert(avl_cursor_seek(&c, -5)->key == 0);
+    
+    VisitLog log = { {0}, 0, 64 };
+    assert(avl_visit_range(root, 95, 141, record_key, &log) == 5);
+    assert(log.keys[0] == 100 && log.keys[4] == 140);
+    log.count = 0;
+    log.limit = 3;
+    assert(avl_visit_range(root, 0, 990, record_key, &log) == 3);
+    assert(log.keys[2] == 20);
+    assert(avl_visit_range(root, 500, 400, record_key, &log) == 0);
+    
+    avl_free(root);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_avl_lazy_delete
+ * @brief Tombstones hide keys from search and cursors until the threshold
+ * triggers one compaction back to a clean, balanced tree
+ */
+int test_avl_lazy_delete(void) {
+    printf("Test: Lazy delete with tombstones and compaction... ");
+    const int n = 10000;
+    AVLTree* tree = avl_create_pooled(0);
+    avl_set_sized(tree, 1);
+    for (int i = 0; i < n; i++) {
+        avl_tree_insert(tree, i);
+    }
+    avl_set_lazy_delete(tree, 0.25);
+    
+    AVLNode* root = tree->root;
+    for (int i = 0; i < n; i += 5) {
+        assert(avl_tree_delete(tree, i) == 1);     /* 2000 tombstones */
+    }
+    assert(avl_tree_delete(tree, 0) == 0);         /* already dead */
+    assert(avl_tree_delete(tree, n) == 0);         /* absent */
+    assert(tree->root == root && tree->tombstones == 2000);
+    assert(tree->nodes == n);                      /* no restructuring */
+    
+    /* Searches, neighbours and cursors skip tombstones */
+    assert(avl_search(tree->root, 500) == NULL);
+    assert(avl_search(tree->root, 501) != NULL);
+    assert(avl_floor(tree->root, 500)->key == 499);
+    assert(avl_ceil(tree->root, 500)->key == 501);
+    assert(avl_successor(tree->root, 499)->key == 501);
+    assert(avl_predecessor(tree->root, 501)->key == 499);
+    
+    AVLCursor c;
+    avl_cursor_init(&c, tree->root);
+    int seen = 0, prev = -1;
+    for (AVLNode* node = avl_cursor_first(&c); node; node = avl_cursor_next(&c)) {
+        assert(node->key % 5 != 0 && node->key > prev);
+        prev = node->key;
+        seen++;
+    }
+    assert(seen == 8000);
+    assert(avl_cursor_first(&c)->key == 1);
+    assert(avl_cursor_seek(&c, 10)->key == 11);
+    assert(avl_cursor_prev(&c)->key == 9);
+    
+    VisitLog log = { {0}, 0, 64 };
+    assert(avl_visit_range(tree->root, 0, 10, record_key, &log) == 8);
+    
+    /* Sizes count live nodes only, and so do the order statistics */
+    assert(verify_heights(tree->root) != INT_MIN);
+    assert(avl_size(tree->root) == 8000);
+    assert(avl_rank(tree->root, 501) == 400 && avl_rank(tree->root, 500) == 400);
+    assert(avl_select(tree->root, 0)->key == 1);
+    assert(avl_select(tree->root, 400)->key == 501);
+    assert(avl_select(tree->root, 7999)->key == 9999);
+    assert(avl_select(tree->root, 8000) == NULL);
+    assert(avl_range_count(tree->root, 0, 10) == 8);
+    for (unsigned int r = 0; r < 1000; r += 37) {
+        assert(avl_sample(tree->root, r)->key % 5 != 0);
+    }
+    
+    /* Reinsert revives in place; range delete counts live keys only */
+    assert(avl_tree_insert(tree, 500)->dead == 0);
+    assert(tree->tombstones == 1999 && avl_search(tree->root, 500));
+    assert(avl_size(tree->root) == 8001 && avl_rank(tree->root, 501) == 401);
+    assert(verify_heights(tree->root) != INT_MIN);
+    assert(avl_tree_delete_range(tree, 9990, 9999) == 8);
+    assert(tree->tombstones == 1997 && tree->nodes == n - 10);
+    assert(avl_size(tree->root) == 7993);
+    
+    /* Crossing 25% compacts: tombstones are released, tree is minimal */
+    for (int i = 1; i < n && tree->tombstones; i += 5) {
+        avl_tree_delete(tree, i);
+    }
+    assert(tree->tombstones == 0);
+    int live = tree->nodes;
+    assert(verify_heights(tree->root) != INT_MIN && verify_balance(tree->root));
+    assert(count_nodes(tree->root) == live);
+    assert(pool_live(tree->pool) == (size_t)live);
+    assert(avl_search(tree->root, 2) && !avl_search(tree->root, 1));
+    
+    /* Eager mode again: deleting a leftover tombstone unlinks it */
+    avl_tree_delete(tree, 2);
+    avl_set_lazy_delete(tree, 0.0);
+    assert(avl_tree_delete(tree, 2) == 0 && tree->tombstones == 0);
+    assert(avl_tree_delete(tree, 3) == 1);
+    assert(count_nodes(tree->root) == live - 2 && avl_size(tree->root) == live - 2);
+    assert(verify_heights(tree->root) != INT_MIN);
+    
+    avl_tree_compact(tree);
+    assert(count_nodes(tree->root) == live - 2);
+    avl_destroy(tree);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_avl_batch_apply
+ * @brief Sorted insert/delete batches match one-at-a-time application and
+ * leave a valid AVL tree, on one thread and on several
+ */
+int test_avl_batch_apply(void) {
+    printf("Test: Batched sorted mutation apply... ");
+    const int range = 200000;
+    unsigned char* present = calloc(range, 1);
+    AVLBatchOp* ops = malloc(sizeof(AVLBatchOp) * range);
+    AVLTree* tree = avl_create_pooled(0);
+    avl_set_sized(tree, 1);
+    unsigned int x = 777;
+    
+    for (int i = 0; i < 60000; i++) {
+        x = x * 1103515245u + 12345u;
+        int key = (int)((x >> 4) % range);
+        avl_tree_insert(tree, key);
+        present[key] = 1;
+    }
+    
+    for (int round = 0; round < 4; round++) {
+        int m = 0, expect = 0;
+        for (int key = 0; key < range; key++) {
+            x = x * 1103515245u + 12345u;
+            if ((x >> 8) % 4 != 0) continue;   /* about 50000 ops */
+            ops[m].key = key;
+            ops[m].kind = (x >> 12) % 2 ? AVL_BATCH_INSERT : AVL_BATCH_DELETE;
+            int now = ops[m].kind == AVL_BATCH_INSERT;
+            expect += present[key] != now;
+            present[key] = (unsigned char)now;
+            m++;
+        }
+        
+        assert(avl_tree_apply(tree, ops, m, round % 2 ? 4 : 1) == expect);
+        assert(verify_heights(tree->root) != INT_MIN && verify_balance(tree->root));
+        
+        int live = 0;
+        for (int key = 0; key < range; key++) {
+            live += present[key];
+        }
+        assert(avl_size(tree->root) == live && tree->nodes == live);
+        assert(pool_live(tree->pool) == (size_t)live);
+        for (int key = 0; key < range; key += 101) {
+            assert((avl_search(tree->root, key) != NULL) == present[key]);
+        }
+    }
+    
+    /* Unsorted batches are rejected untouched */
+    AVLBatchOp bad[] = { {5, AVL_BATCH_INSERT}, {5, AVL_BATCH_DELETE} };
+    assert(avl_tree_apply(tree, bad, 2, 1) == -1);
+    
+    /* Batches revive and remove tombstones */
+    avl_set_lazy_delete(tree, 0.5);
+    int a = avl_select(tree->root, 10)->key, b = avl_select(tree->root, 20)->key;
+    avl_tree_delete(tree, a);
+    avl_tree_delete(tree, b);
+    AVLBatchOp fix[] = { {a, AVL_BATCH_INSERT}, {b, AVL_BATCH_DELETE} };
+    assert(avl_tree_apply(tree, fix, 2, 1) == 1);
+    assert(tree->tombstones == 0 && avl_search(tree->root, a));
+    avl_destroy(tree);
+    
+    /* Node-level: build from empty, then delete everything */
+    for (int i = 0; i < 10000; i++) {
+        ops[i].key = i * 2;
+        ops[i].kind = AVL_BATCH_INSERT;
+    }
+    AVLNode* root = avl_apply_batch(NULL, ops, 10000, 4);
+    assert(avl_size(root) == 10000 && avl_height(root) == 13);
+    for (int i = 0; i < 10000; i++) {
+        ops[i].kind = AVL_BATCH_DELETE;
+    }
+    root = avl_apply_batch(root, ops, 10000, 4);
+    assert(root == NULL);
+    
+    free(ops);
+    free(present);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_avl_search_batch
+ * @brief Interleaved batch lookups agree with avl_search, tombstones included
+ */
+int test_avl_search_batch(void) {
+    printf("Test: Batched interleaved search... ");
+    const int n = 1000;
+    AVLTree* tree = avl_create_pooled(0);
+    for (int i = 0; i < 20000; i++) {
+        avl_tree_insert(tree, (i * 7919) % 20000 * 2);  /* even keys */
+    }
+    avl_set_lazy_delete(tree, 0.5);
+    avl_tree_delete(tree, 100);
+    
+    int* keys = malloc(sizeof(int) * n);
+    AVLNode** out = malloc(sizeof(AVLNode*) * n);
+    int expect = 0;
+    for (int i = 0; i < n; i++) {
+        keys[i] = (i * 37) % 45000 - 1000;               /* hits, misses, negatives */
+        if (i == 7) keys[i] = 100;
+        expect += avl_search(tree->root, keys[i]) != NULL;
+    }
+    
+    assert(avl_search_batch(tree->root, keys, n, out) == expect);
+    for (int i = 0; i < n; i++) {
+        assert(out[i] == avl_search(tree->root, keys[i]));
+    }
+    assert(out[7] == NULL);
+    
+    /* Batches smaller than the window, empty batch, empty tree */
+    int small = avl_search_batch(tree->root, keys, 3, out);
+    assert(small == (out[0] != NULL) + (out[1] != NULL) + (out[2] != NULL));
+    assert(avl_search_batch(tree->root, keys, 0, out) == 0);
+    assert(avl_search_batch(NULL, keys, n, out) == 0 && out[n - 1] == NULL);
+    
+    free(keys);
+    free(out);
+    avl_destroy(tree);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_avl_bloom
+ * @brief The filter never hides a live key, rejects most misses, and is
+ * rebuilt once deletes make it stale
+ */
+int test_avl_bloom(void) {
+    printf("Test: Bloom filter front for misses... ");
+    const int n = 50000;
+    AVLTree* tree = avl_create_pooled(0);
+    for (int i = 0; i < n / 2; i++) {
+        avl_tree_insert(tree, i * 2);
+    }
+    assert(avl_tree_enable_bloom(tree, 0));
+    for (int i = n / 2; i < n; i++) {
+        avl_tree_insert(tree, i * 2);              /* grows past capacity */
+    }
+    
+    int passed_filter = 0;
+    for (int i = 0; i < n; i++) {
+        assert(avl_tree_search(tree, i * 2) != NULL);
+        passed_filter += bloom_may_contain(tree->bloom, i * 2 + 1);
+        assert(avl_tree_search(tree, i * 2 + 1) == NULL);
+    }
+    assert(passed_filter < n / 30);                /* about 1% expected */
+    
+    /* Deleting most keys makes the filter stale and forces a rebuild */
+    for (int i = 0; i < n; i += 4) {
+        avl_tree_delete(tree, i * 2);
+    }
+    assert(avl_tree_delete_range(tree, 0, 9999) > 0);
+    AVLBatchOp ops[] = { {1, AVL_BATCH_INSERT}, {12, AVL_BATCH_DELETE} };
+    avl_tree_apply(tree, ops, 2, 1);
+    passed_filter = 0;
+    for (int i = 0; i < n; i++) {
+        int key = i * 2;
+        int live = key >= 10000 && i % 4 != 0;
+        assert((avl_tree_search(tree, key) != NULL) == live);
+        if (!live) passed_filter += bloom_may_contain(tree->bloom, key);
+    }
+    assert(avl_tree_search(tree, 1) != NULL);
+    assert(passed_filter < n / 10);
+    
+    /* Tombstones stay behind the filter until compaction drops them */
+    avl_set_lazy_delete(tree, 0.5);
+    avl_tree_delete(tree, 10002);
+    assert(avl_tree_search(tree, 10002) == NULL);
+    avl_tree_compact(tree);
+    assert(avl_tree_search(tree, 10006) != NULL);
+    
+    avl_destroy(tree);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_avl_multiset
+ * @brief Counts survive rotations, successor deletes and compaction; the
+ * last copy goes through lazy delete and comes back with count 1
+ */
+int test_avl_multiset(void) {
+    printf("Test: Multiset mode counts... ");
+    const int n = 1000;
+    AVLTree* tree = avl_create_pooled(0);
+    assert(avl_set_multiset(tree, 1));
+    for (int round = 1; round <= 3; round++) {
+        for (int i = 0; i < n; i++) {
+            if (i % round == 0) avl_tree_insert(tree, i);
+        }
+    }
+    
+    size_t live = pool_live(tree->pool);
+    AVLNode* root = tree->root;
+    int height = avl_height(root);
+    assert(avl_tree_insert(tree, 6)->count == 4);
+    assert(pool_live(tree->pool) == live && tree->root == root &&
+           avl_height(root) == height);
+    assert(avl_size(tree->root) == n);
+    
+    for (int i = 0; i < n; i += 5) avl_tree_delete(tree, i);
+    for (int i = 0; i < n; i++) {
+        int copies = 1 + (i % 2 == 0) + (i % 3 == 0) + (i == 6);
+        assert(avl_tree_count(tree, i) == copies - (i % 5 == 0));
+    }
+    
+    avl_set_lazy_delete(tree, 0.9);
+    assert(avl_tree_delete(tree, 1) && avl_tree_count(tree, 1) == 0);
+    assert(!avl_tree_delete(tree, 1));
+    assert(avl_tree_insert(tree, 1)->count == 1);
+    avl_tree_delete(tree, 1);
+    avl_tree_compact(tree);
+    assert(avl_tree_count(tree, 1) == 0 && avl_tree_count(tree, 6) == 4);
+    
+    /* A count at its limit rejects the next copy instead of wrapping */
+    avl_search(tree->root, 6)->count = AVL_MAX_COUNT - 1;
+    assert(avl_tree_insert(tree, 6) != NULL);
+    assert(avl_tree_insert(tree, 6) == NULL);
+    assert(avl_tree_count(tree, 6) == AVL_MAX_COUNT);
+    
+    avl_destroy(tree);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_avl_sized_mode
+ * @brief A tree handle keeps no subtree sizes unless asked to: updates
+ * leave them alone, counts still agree, and order statistics refuse
+ */
+int test_avl_sized_mode(void) {
+    printf("Test: Optional subtree sizes... ");
+    AVLTree* plain = avl_create_pooled(0);
+    AVLTree* sized = avl_create_pooled(0);
+    assert(avl_set_sized(sized, 1));
+    unsigned int x = 99;
+    
+    for (int i = 0; i < 5000; i++) {
+        x = x * 1103515245u + 12345u;
+        int key = (int)((x >> 4) % 10000);
+        avl_tree_insert(plain, key);
+        avl_tree_insert(sized, key);
+    }
+    for (int key = 0; key < 10000; key += 7) {
+        avl_tree_delete(plain, key);
+        avl_tree_delete(sized, key);
+    }
+    AVLBatchOp ops[] = { {3, AVL_BATCH_INSERT}, {5, AVL_BATCH_DELETE},
+                         {10001, AVL_BATCH_INSERT} };
+    assert(avl_tree_apply(plain, ops, 3, 1) == avl_tree_apply(sized, ops, 3, 1));
+    assert(avl_tree_delete_range(plain, 2000, 2999) ==
+           avl_tree_delete_range(sized, 2000, 2999));
+    
+    int n = count_nodes(sized->root);
+    assert(sizes_untouched(plain->root));
+    assert(verify_heights(plain->root) != INT_MIN && verify_balance(plain->root));
+    assert(verify_heights(sized->root) != INT_MIN && sized->root->size == n);
+    assert(plain->nodes == n && sized->nodes == n && avl_size(plain->root) == n);
+    assert(avl_range_count(plain->root, 0, 4999) == avl_range_count(sized->root, 0, 4999));
+    
+    /* Order statistics need sizes */
+    assert(avl_rank(plain->root, 500) == -1);
+    assert(avl_select(plain->root, 0) == NULL && avl_sample(plain->root, 7) == NULL);
+    assert(avl_select(sized->root, 0) == avl_ceil(sized->root, INT_MIN));
+    assert(!avl_set_sized(plain, 1));              /* not empty */
+    
+    avl_destroy(plain);
+    avl_destroy(sized);
+    printf("PASS\n");
+    return 1;
+}
+
 /* ============================================================================
  * Test Runner
  * ============================================================================
@@ -328,6 +1166,22 @@ int main(void) {
     if (test_avl_duplicate_insert()) passed++; else failed++;
     if (test_avl_delete_all()) passed++; else failed++;
     if (test_avl_empty_operations()) passed++; else failed++;
+    if (test_avl_pooled_tree()) passed++; else failed++;
+    if (test_avl_large_churn()) passed++; else failed++;
+    if (test_avl_build_sorted()) passed++; else failed++;
+    if (test_avl_bulk_load()) passed++; else failed++;
+    if (test_avl_split_join()) passed++; else failed++;
+    if (test_avl_set_operations()) passed++; else failed++;
+    if (test_avl_range_queries()) passed++; else failed++;
+    if (test_avl_order_statistics()) passed++; else failed++;
+    if (test_avl_neighbours()) passed++; else failed++;
+    if (test_avl_cursor()) passed++; else failed++;
+    if (test_avl_lazy_delete()) passed++; else failed++;
+    if (test_avl_batch_apply()) passed++; else failed++;
+    if (test_avl_search_batch()) passed++; else failed++;
+    if (test_avl_bloom()) passed++; else failed++;
+    if (test_avl_multiset()) passed++; else failed++;
+    if (test_avl_sized_mode()) passed++; else failed++;
     
     printf("\n========================================\n");
     printf("  TEST SUMMARY\n");
@@ -0,0 +1,159 @@
+/**
+ * @file test_avl_agg.c
+ * @brief Unit tests for the aggregate-augmented AVL tree
+ * 
+ * Tests cached subtree aggregates after inserts, updates, deletes and
+ * rotations, and range aggregates against a brute-force scan
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <limits.h>
+#include "../include/avl_agg.h"
+
+/* ============================================================================
+ * Test Utilities
+ * ============================================================================
+ */
+
+/**
+ * @brief Verify balance, heights and cached aggregates of every node
+ * Returns the height, or INT_MIN on violation
+ */
+static int verify_agg(AVLAggNode* node) {
+    if (!node) return -1;
+    
+    int hl = verify_agg(node->left);
+    int hr = verify_agg(node->right);
+    if (hl == INT_MIN || hr == INT_MIN) return INT_MIN;
+    if (hl - hr > 1 || hr - hl > 1) return INT_MIN;
+    
+    int count = 1;
+    long long sum = node->value, mn = node->value, mx = node->value;
+    AVLAggNode* kids[2] = { node->left, node->right };
+    for (int i = 0; i < 2; i++) {
+        if (!kids[i]) continue;
+        count += kids[i]->count;
+        sum += kids[i]->sum;
+        if (kids[i]->min < mn) mn = kids[i]->min;
+        if (kids[i]->max > mx) mx = kids[i]->max;
+    }
+    if (node->count != count || node->sum != sum || node->min != mn || node->max != mx) {
+        printf("ERROR: Stale aggregate at node %d\n", node->key);
+        return INT_MIN;
+    }
+    
+    int h = 1 + (hl > hr ? hl : hr);
+    return node->height == h ? h : INT_MIN;
+}
+
+/* ============================================================================
+ * Test Cases
+ * ============================================================================
+ */
+
+/**
+ * @test test_agg_insert_update_delete
+ * @brief Aggregates stay exact through inserts, overwrites, adds and deletes
+ */
+int test_agg_insert_update_delete(void) {
+    printf("Test: Aggregates through insert/update/delete... ");
+    AVLAggNode* root = NULL;
+    
+    for (int i = 0; i < 1000; i++) {
+        root = avl_agg_insert(root, i, i);   /* ascending: many rotations */
+    }
+    assert(verify_agg(root) != INT_MIN);
+    assert(root->count == 1000 && root->sum == 999 * 1000 / 2);
+    assert(root->min == 0 && root->max == 999);
+    
+    root = avl_agg_insert(root, 500, -7);    /* overwrite */
+    root = avl_agg_add(root, 10, 100);       /* increment */
+    root = avl_agg_add(root, 5000, 3);       /* add inserts */
+    assert(verify_agg(root) != INT_MIN);
+    assert(root->count == 1001);
+    assert(root->sum == 999 * 1000 / 2 - 500 - 7 + 100 + 3);
+    assert(root->min == -7 && avl_agg_search(root, 10)->value == 110);
+    
+    for (int i = 0; i < 1000; i += 3) {
+        root = avl_agg_delete(root, i);
+    }
+    root = avl_agg_delete(root, 123456);     /* absent */
+    assert(verify_agg(root) != INT_MIN);
+    assert(root->count == 1001 - 334);
+    
+    avl_agg_free(root);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_agg_range
+ * @brief Range aggregates match a brute-force scan
+ */
+int test_agg_range(void) {
+    printf("Test: Range aggregates... ");
+    const int n = 2000;
+    long long* values = malloc(sizeof(long long) * n);
+    AVLAggNode* root = NULL;
+    
+    for (int i = 0; i < n; i++) {
+        int key = (i * 7919) % n;
+        values[key] = (long long)((key * 2654435761u) % 1000) - 500;
+        root = avl_agg_insert(root, key, values[key]);
+    }
+    assert(verify_agg(root) != INT_MIN);
+    
+    int bounds[][2] = { {0, n - 1}, {10, 20}, {-50, 5}, {1990, 5000}, {777, 777},
+                        {300, 1700}, {INT_MIN, INT_MAX}, {5, 4}, {n, n + 10} };
+    for (int b = 0; b < 9; b++) {
+        int lo = bounds[b][0], hi = bounds[b][1];
+        int count = 0;
+        long long sum = 0, mn = LLONG_MAX, mx = LLONG_MIN;
+        for (int k = 0; k < n; k++) {
+            if (k < lo || k > hi) continue;
+            count++;
+            sum += values[k];
+            if (values[k] < mn) mn = values[k];
+            if (values[k] > mx) mx = values[k];
+        }
+        
+        AVLAggregate agg = avl_agg_range(root, lo, hi);
+        assert(agg.count == count && agg.sum == sum);
+        if (count) assert(agg.min == mn && agg.max == mx);
+    }
+    
+    avl_agg_free(root);
+    free(values);
+    printf("PASS\n");
+    return 1;
+}
+
+/* ============================================================================
+ * Test Runner
+ * ============================================================================
+ */
+
+int main(void) {
+    printf("\n========================================\n");
+    printf("  AUGMENTED AVL UNIT TESTS\n");
+    printf("========================================\n\n");
+    
+    int passed = 0;
+    int failed = 0;
+    
+    /* Run all tests */
+    if (test_agg_insert_update_delete()) passed++; else failed++;
+    if (test_agg_range()) passed++; else failed++;
+    
+    printf("\n========================================\n");
+    printf("  TEST SUMMARY\n");
+    printf("========================================\n");
+    printf("Passed: %d\n", passed);
+    printf("Failed: %d\n", failed);
+    printf("Total:  %d\n", passed + failed);
+    printf("========================================\n\n");
+    
+    return (failed == 0) ? 0 : 1;
+}
@@ -10,6 +10,7 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <limits.h>
+#include <stdint.h>
 #include "../include/bst.h"
 
 /* ============================================================================
@@ -60,6 +61,68 @@ static int verify_bst_property(BSTNode* root, int min, int max) {
            verify_bst_property(root->right, root->key, max);
 }
 
+/**
+ * @brief Verify kept subtree sizes; returns the size or -1 on mismatch
+ */
+static int verify_sizes(BSTNode* node) {
+    if (!node) return 0;
+    
+    int l = verify_sizes(node->left);
+    int r = verify_sizes(node->right);
+    if (l < 0 || r < 0) return -1;
+    if (node->sized && node->size != l + r + 1) {
+        printf("ERROR: Node %d stores size %d, actual %d\n", node->key, node->size, l + r + 1);
+        return -1;
+    }
+    return l + r + 1;
+}
+
+/**
+ * @brief Number of levels in the tree
+ */
+static int tree_depth(BSTNode* root) {
+    if (!root) return 0;
+    int l = tree_depth(root->left);
+    int r = tree_depth(root->right);
+    return 1 + (l > r ? l : r);
+}
+
+/**
+ * @brief Nodes sit at strictly rising addresses in preorder, i.e. they
+ * were carved one after another out of a single slab
+ */
+static int laid_out_in_preorder(BSTNode* node, uintptr_t* last) {
+    if (!node) return 1;
+    if ((uintptr_t)node <= *last) return 0;
+    *last = (uintptr_t)node;
+    return laid_out_in_preorder(node->left, last) &&
+           laid_out_in_preorder(node->right, last);
+}
+
+/**
+ * @brief No node keeps a size, and none was touched since it was created
+ */
+static int sizes_untouched(BSTNode* node) {
+    if (!node) return 1;
+    if (node->sized || node->size != 1) return 0;
+    return sizes_untouched(node->left) && sizes_untouched(node->right);
+}
+
+/**
+ * @brief Range visitor: records keys, stops after `limit` of them
+ */
+typedef struct {
+    int keys[64];
+    int count;
+    int limit;
+} VisitLog;
+
+static int record_key(BSTNode* node, void* arg) {
+    VisitLog* log = arg;
+    log->keys[log->count++] = node->key;
+    return log->count < log->limit;
+}
+
 /* ============================================================================
  * Test Cases
  * ============================================================================
@@ -362,6 +425,481 @@ int test_bst_min_max(void) {
     return 1;
 }
 
+/**
+ * @test test_bst_pooled_recycling
+ * @brief Pooled tree reuses freed nodes instead of growing
+ */
+int test_bst_pooled_recycling(void) {
+    printf("Test: Pooled tree recycles nodes... ");
+    BSTree* tree = bst_create_pooled(16);
+    assert(tree != NULL);
+    
+    for (int i = 0; i < 40; i++) {
+        bst_tree_insert(tree, (i * 7) % 40);
+    }
+    assert(pool_live(tree->pool) == 40);
+    assert(count_nodes(tree->root) == 40);
+    size_t slabs = pool_slab_count(tree->pool);
+    
+    for (int i = 0; i < 20; i++) {
+        bst_tree_delete(tree, i);
+    }
+    assert(pool_live(tree->pool) == 20);
+    assert(verify_bst_property(tree->root, INT_MIN, INT_MAX));
+    
+    /* Re-inserting must come from the free list, not new slabs */
+    for (int i = 100; i < 120; i++) {
+        assert(bst_tree_insert(tree, i)->key == i);
+    }
+    assert(pool_live(tree->pool) == 40);
+    assert(pool_slab_count(tree->pool) == slabs);
+    
+    bst_destroy(tree);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_bst_degenerate_deep
+ * @brief Sorted input builds a deep chain without exhausting the stack
+ */
+int test_bst_degenerate_deep(void) {
+    printf("Test: Degenerate sorted input (depth 20000)... ");
+    const int n = 20000;
+    BSTNode* root = NULL;
+    
+    for (int i = 0; i < n; i++) {
+        root = bst_insert(root, i);
+    }
+    assert(bst_search(root, n - 1) != NULL);
+    assert(bst_search(root, n) == NULL);
+    
+    int* inorder = malloc(sizeof(int) * n);
+    int idx = 0;
+    bst_inorder(root, inorder, &idx);
+    assert(idx == n);
+    assert(is_sorted(inorder, n));
+    free(inorder);
+    
+    /* Delete deepest, middle and root */
+    root = bst_delete(root, n - 1);
+    root = bst_delete(root, n / 2);
+    root = bst_delete(root, 0);
+    assert(bst_search(root, n - 1) == NULL);
+    assert(bst_search(root, n / 2) == NULL);
+    assert(root->key == 1);
+    
+    bst_free(root);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_bst_build_sorted
+ * @brief Bulk build gives a minimum-height tree
+ */
+int test_bst_build_sorted(void) {
+    printf("Test: Build from sorted array... ");
+    int keys[1000];
+    for (int i = 0; i < 1000; i++) keys[i] = i * 3;
+    
+    BSTNode* root = bst_build_sorted(keys, 1000);
+    assert(count_nodes(root) == 1000);
+    assert(verify_bst_property(root, INT_MIN, INT_MAX));
+    assert(tree_depth(root) == 10);  /* ceil(log2(1001)) levels */
+    assert(bst_search(root, 999 * 3) != NULL);
+    bst_free(root);
+    
+    int unsorted[] = {1, 3, 2};
+    assert(bst_build_sorted(unsorted, 3) == NULL);
+    assert(bst_build_sorted(keys, 0) == NULL);
+    
+    /* Tree handle: nodes come from the pool in preorder */
+    BSTree* tree = bst_create_pooled(1000);
+    uintptr_t last = 0;
+    assert(!bst_tree_build_sorted(tree, unsorted, 3) && tree->root == NULL);
+    assert(bst_tree_build_sorted(tree, keys, 1000));
+    assert(verify_sizes(tree->root) == 1000 && tree_depth(tree->root) == 10);
+    assert(laid_out_in_preorder(tree->root, &last));
+    assert(pool_live(tree->pool) == 1000);
+    assert(!bst_tree_build_sorted(tree, keys, 1000));   /* not empty */
+    bst_destroy(tree);
+    
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_bst_bulk_load
+ * @brief Parallel bulk load sorts, drops duplicates and balances
+ */
+int test_bst_bulk_load(void) {
+    printf("Test: Parallel bulk load from unsorted keys... ");
+    const int n = 200000;
+    int* keys = malloc(sizeof(int) * n);
+    unsigned int x = 12345;
+    for (int i = 0; i < n; i++) {
+        x = x * 1103515245u + 12345u;
+        keys[i] = (int)(x >> 1) % 50000 - 25000;  /* many duplicates, negatives */
+    }
+    
+    BSTNode* root = bst_bulk_load(keys, n, 4);
+    int nodes = count_nodes(root);
+    assert(nodes > 0 && nodes <= 50000);
+    assert(verify_bst_property(root, INT_MIN, INT_MAX));
+    assert(tree_depth(root) <= 16);
+    for (int i = 0; i < n; i += 997) {
+        assert(bst_search(root, keys[i]) != NULL);
+    }
+    
+    /* Same result single-threaded */
+    BSTNode* serial = bst_bulk_load(keys, n, 1);
+    assert(count_nodes(serial) == nodes);
+    
+    /* Pooled: the threads fill nodes carved up front in preorder */
+    BSTree* tree = bst_create_pooled((size_t)nodes);
+    uintptr_t last = 0;
+    assert(bst_tree_bulk_load(tree, keys, n, 4));
+    assert(verify_sizes(tree->root) == nodes);
+    assert(laid_out_in_preorder(tree->root, &last));
+    assert(pool_live(tree->pool) == (size_t)nodes);
+    bst_destroy(tree);
+    
+    bst_free(root);
+    bst_free(serial);
+    free(keys);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_bst_range_queries
+ * @brief Range count matches a scan; range delete keeps the BST property
+ * and sizes, including on a degenerate chain
+ */
+int test_bst_range_queries(void) {
+    printf("Test: Range count and range delete... ");
+    BSTree* tree = bst_create_pooled(0);
+    bst_set_sized(tree, 1);
+    for (int i = 0; i < 5000; i++) {
+        bst_tree_insert(tree, (i * 7919) % 5000 * 2);  /* even keys 0..9998 */
+    }
+    bst_tree_delete(tree, 4444);
+    bst_tree_insert(tree, 4444);
+    assert(verify_sizes(tree->root) == 5000);
+    
+    assert(bst_range_count(tree->root, 0, 9998) == 5000);
+    assert(bst_range_count(tree->root, 1, 1) == 0);
+    assert(bst_range_count(tree->root, 10, 20) == 6);
+    assert(bst_range_count(tree->root, 11, 19) == 4);
+    assert(bst_range_count(tree->root, INT_MIN, INT_MAX) == 5000);
+    assert(bst_range_count(tree->root, 20, 10) == 0);
+    
+    assert(bst_tree_delete_range(tree, 1001, 2999) == 999);
+    assert(verify_bst_property(tree->root, INT_MIN, INT_MAX));
+    assert(verify_sizes(tree->root) == 4001);
+    assert(bst_search(tree->root, 1000) && bst_search(tree->root, 3000));
+    assert(!bst_search(tree->root, 2000));
+    
+    assert(bst_tree_delete_range(tree, 4000, 4000) == 1);
+    assert(bst_tree_delete_range(tree, 2000, 2998) == 0);
+    assert(bst_tree_delete_range(tree, INT_MIN, 500) == 251);
+    assert(bst_tree_delete_range(tree, 9000, INT_MAX) == 500);
+    assert(verify_sizes(tree->root) == 3249);
+    assert(pool_live(tree->pool) == 3249);
+    bst_destroy(tree);
+    
+    /* Ascending inserts: a right-leaning chain */
+    BSTNode* chain = NULL;
+    for (int i = 0; i < 1000; i++) chain = bst_insert(chain, i);
+    chain = bst_delete_range(chain, 100, 899);
+    assert(verify_sizes(chain) == 200);
+    assert(bst_range_count(chain, 0, 999) == 200);
+    chain = bst_delete_range(chain, 0, 999);
+    assert(chain == NULL);
+    
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_bst_neighbours
+ * @brief floor/ceil/predecessor/successor match a brute-force scan
+ */
+int test_bst_neighbours(void) {
+    printf("Test: Floor, ceil, predecessor, successor... ");
+    BSTNode* root = NULL;
+    for (int i = 0; i < 100; i++) {
+        root = bst_insert(root, (i * 37) % 100 * 10);
+    }
+    
+    /* Keys are multiples of 10 in [0, 990] */
+    for (int q = -15; q <= 1005; q++) {
+        int fl = q < 0 ? -1 : (q > 990 ? 990 : q / 10 * 10);
+        int ce = q > 990 ? -1 : (q <= 0 ? 0 : (q + 9) / 10 * 10);
+        int pr = q <= 0 ? -1 : (q > 990 ? 990 : (q - 1) / 10 * 10);
+        int su = q >= 990 ? -1 : (q < 0 ? 0 : q / 10 * 10 + 10);
+        
+        BSTNode* n = bst_floor(root, q);
+        assert(fl < 0 ? n == NULL : n->key == fl);
+        n = bst_ceil(root, q);
+        assert(ce < 0 ? n == NULL : n->key == ce);
+        n = bst_predecessor(root, q);
+        assert(pr < 0 ? n == NULL : n->key == pr);
+        n = bst_successor(root, q);
+        assert(su < 0 ? n == NULL : n->key == su);
+    }
+    
+    bst_free(root);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_bst_cursor
+ * @brief Cursor walks both ways, seeks to the ceiling, and bounded visits
+ * stop early; a deep chain needs no recursion
+ */
+int test_bst_cursor(void) {
+    printf("Test: Cursor and range visit... ");
+    BSTNode* root = NULL;
+    for (int i = 0; i < 100; i++) root = bst_insert(root, (i * 37) % 100 * 10);
+    
+    BSTCursor c;
+    bst_cursor_init(&c, root);
+    BSTNode* node = bst_cursor_first(&c);
+    for (int k = 0; k < 100; k++, node = bst_cursor_next(&c)) assert(node->key == k * 10);
+    assert(node == NULL);
+    node = bst_cursor_last(&c);
+    for (int k = 99; k >= 0; k--, node = bst_cursor_prev(&c)) assert(node->key == k * 10);
+    assert(node == NULL);
+    
+    assert(bst_cursor_seek(&c, 455)->key == 460);
+    assert(bst_cursor_prev(&c)->key == 450);
+    assert(bst_cursor_seek(&c, 460)->key == 460);
+    assert(bst_cursor_next(&c)->key == 470);
+    assert(bst_cursor_seek(&c, 991) == NULL);
+    assert(bst_cursor_seek(&c, -5)->key == 0);
+    bst_cursor_release(&c);
+    
+    VisitLog log = { {0}, 0, 64 };
+    assert(bst_visit_range(root, 95, 141, record_key, &log) == 5);
+    assert(log.keys[0] == 100 && log.keys[4] == 140);
+    log.count = 0;
+    log.limit = 3;
+    assert(bst_visit_range(root, 0, 990, record_key, &log) == 3);
+    assert(log.keys[2] == 20);
+    assert(bst_visit_range(root, 500, 400, record_key, &log) == 0);
+    bst_free(root);
+    
+    BSTNode* chain = NULL;
+    for (int i = 0; i < 20000; i++) chain = bst_insert(chain, -i);
+    bst_cursor_init(&c, chain);
+    node = bst_cursor_first(&c);
+    for (int i = 19999; i >= 0; i--, node = bst_cursor_next(&c)) assert(node->key == -i);
+    assert(node == NULL);
+    bst_cursor_release(&c);
+    bst_free(chain);
+    
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_bst_rebalance
+ * @brief DSW turns a degenerate chain into a minimum-height tree; the
+ * automatic trigger keeps sorted inserts within c * log2(n)
+ */
+int test_bst_rebalance(void) {
+    printf("Test: DSW rebalance and auto trigger... ");
+    BSTNode* root = NULL;
+    for (int i = 0; i < 3000; i++) {
+        root = bst_insert(root, i);  /* right chain */
+    }
+    assert(tree_depth(root) == 3000);
+    
+    root = bst_rebalance(root);
+    assert(tree_depth(root) == 12);  /* ceil(log2(3001)) levels */
+    assert(count_nodes(root) == 3000);
+    assert(verify_bst_property(root, INT_MIN, INT_MAX));
+    assert(verify_sizes(root) == 3000);
+    
+    /* Left chain and odd shapes; empty and single trees */
+    for (int i = -1; i >= -1000; i--) {
+        root = bst_insert(root, i);
+    }
+    root = bst_rebalance(root);
+    assert(tree_depth(root) == 12);
+    assert(verify_bst_property(root, INT_MIN, INT_MAX));
+    assert(verify_sizes(root) == 4000);
+    bst_free(root);
+    assert(bst_rebalance(NULL) == NULL);
+    root = bst_rebalance(bst_insert(NULL, 7));
+    assert(root->key == 7 && root->size == 1);
+    bst_free(root);
+    
+    /* Auto mode under a sorted (adversarial) stream: scapegoat rebuilds
+     * stay small, O(n log n) rebuilt nodes in total rather than O(n^2) */
+    BSTree* tree = bst_create_pooled(0);
+    bst_set_auto_rebalance(tree, 2.0);
+    for (int i = 0; i < 20000; i++) {
+        bst_tree_insert(tree, i);
+        if (i % 500 == 0) assert(tree_depth(tree->root) <= 2 * 15 + 1);
+    }
+    assert(tree->rebalances > 0 && tree->rebalances <= 20000 / 4);
+    assert(tree->rebuilt <= 20000LL * 15);
+    assert(verify_sizes(tree->root) == 20000);
+    assert(verify_bst_property(tree->root, INT_MIN, INT_MAX));
+    
+    /* Off by default and when switched off */
+    int before = tree->rebalances;
+    bst_set_auto_rebalance(tree, 0.0);
+    for (int i = 20000; i < 20100; i++) {
+        bst_tree_insert(tree, i);
+    }
+    assert(tree->rebalances == before);
+    bst_tree_rebalance(tree);
+    assert(tree_depth(tree->root) == 15);
+    
+    bst_destroy(tree);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_bst_search_sorted
+ * @brief One-walk sorted lookup agrees with bst_search, including repeated
+ * keys and a degenerate chain
+ */
+int test_bst_search_sorted(void) {
+    printf("Test: Sorted batch lookup... ");
+    const int n = 50000, m = 3000;
+    int* keys = malloc(sizeof(int) * n);
+    for (int i = 0; i < n; i++) keys[i] = i * 2;       /* even keys */
+    BSTNode* root = bst_build_sorted(keys, n);
+    
+    int* queries = malloc(sizeof(int) * m);
+    BSTNode** out = malloc(sizeof(BSTNode*) * m);
+    for (int i = 0; i < m; i++) {
+        queries[i] = i * 37 - 500 - (i % 10 == 0);    /* repeats, misses */
+        if (i > 0 && queries[i] < queries[i - 1]) queries[i] = queries[i - 1];
+    }
+    
+    int expect = 0;
+    for (int i = 0; i < m; i++) {
+        expect += bst_search(root, queries[i]) != NULL;
+    }
+    assert(expect > 0);
+    assert(bst_search_sorted(root, queries, m, out) == expect);
+    for (int i = 0; i < m; i++) {
+        assert(out[i] == bst_search(root, queries[i]));
+    }
+    
+    int unsorted[] = { 4, 2 };
+    assert(bst_search_sorted(root, unsorted, 2, out) == -1);
+    assert(bst_search_sorted(root, queries, 0, out) == 0);
+    assert(bst_search_sorted(NULL, queries, m, out) == 0 && out[m - 1] == NULL);
+    bst_free(root);
+    
+    /* Degenerate chain: pending subtrees go on the heap, not the stack */
+    root = NULL;
+    for (int i = 0; i < 20000; i++) {
+        root = bst_insert(root, i);
+    }
+    for (int i = 0; i < m; i++) {
+        queries[i] = i * 7;
+    }
+    assert(bst_search_sorted(root, queries, m, out) == 20000 / 7 + 1);
+    assert(out[0]->key == 0 && out[2857]->key == 19999 && out[2858] == NULL);
+    bst_free(root);
+    
+    free(keys);
+    free(queries);
+    free(out);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_bst_multiset
+ * @brief Repeated inserts bump a count without allocating; deletes
+ * decrement it and remove the node with its last copy
+ */
+int test_bst_multiset(void) {
+    printf("Test: Multiset mode counts... ");
+    BSTree* tree = bst_create_pooled(0);
+    assert(bst_set_multiset(tree, 1));
+    int keys[] = { 50, 30, 70, 30, 30, 70 };
+    for (int i = 0; i < 6; i++) bst_tree_insert(tree, keys[i]);
+    
+    size_t live = pool_live(tree->pool);
+    BSTNode* node = bst_tree_insert(tree, 30);
+    assert(node->count == 4 && pool_live(tree->pool) == live);
+    assert(bst_size(tree->root) == 3);
+    assert(bst_tree_count(tree, 70) == 2 && bst_tree_count(tree, 40) == 0);
+    assert(!bst_set_multiset(tree, 0));            /* not empty */
+    
+    /* Deleting the root copies its successor's count along with the key */
+    assert(bst_tree_delete(tree, 50));
+    assert(bst_tree_count(tree, 70) == 2 && bst_tree_count(tree, 50) == 0);
+    assert(bst_tree_delete(tree, 70) && bst_tree_count(tree, 70) == 1);
+    assert(bst_tree_delete(tree, 70) && bst_tree_count(tree, 70) == 0);
+    assert(!bst_tree_delete(tree, 70));
+    assert(bst_tree_count(tree, 30) == 4 && bst_size(tree->root) == 1);
+    
+    /* A count at its limit rejects the next copy */
+    bst_search(tree->root, 30)->count = BST_MAX_COUNT - 1;
+    assert(bst_tree_insert(tree, 30) != NULL);
+    assert(bst_tree_insert(tree, 30) == NULL);
+    assert(bst_tree_count(tree, 30) == BST_MAX_COUNT);
+    
+    bst_destroy(tree);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_bst_sized_mode
+ * @brief A tree handle keeps no subtree sizes unless asked to: updates
+ * leave them alone, while counts and scapegoat rebuilds match a sized tree
+ */
+int test_bst_sized_mode(void) {
+    printf("Test: Optional subtree sizes... ");
+    BSTree* plain = bst_create_pooled(0);
+    BSTree* sized = bst_create_pooled(0);
+    assert(bst_set_sized(sized, 1));
+    bst_set_auto_rebalance(plain, 2.0);
+    bst_set_auto_rebalance(sized, 2.0);
+    
+    /* Sorted stream: the same scapegoats, found with and without sizes */
+    for (int i = 0; i < 6000; i++) {
+        bst_tree_insert(plain, i);
+        bst_tree_insert(sized, i);
+    }
+    for (int i = 0; i < 6000; i += 3) {
+        assert(bst_tree_delete(plain, i) && bst_tree_delete(sized, i));
+    }
+    assert(bst_tree_delete_range(plain, 100, 399) == 200);
+    assert(bst_tree_delete_range(sized, 100, 399) == 200);
+    assert(plain->rebalances > 0 && plain->rebalances == sized->rebalances);
+    assert(plain->rebuilt == sized->rebuilt);
+    
+    assert(sizes_untouched(plain->root));
+    assert(verify_sizes(sized->root) == 3800);
+    assert(plain->nodes == 3800 && sized->nodes == 3800);
+    assert(count_nodes(plain->root) == 3800 && bst_size(plain->root) == 3800);
+    assert(bst_range_count(plain->root, 0, 999) == bst_range_count(sized->root, 0, 999));
+    int expect = 0;
+    for (int i = 50; i <= 450; i++) expect += i % 3 != 0 && (i < 100 || i > 399);
+    assert(bst_range_count(plain->root, 50, 450) == expect);
+    assert(!bst_set_sized(plain, 1));              /* not empty */
+    
+    bst_destroy(plain);
+    bst_destroy(sized);
+    printf("PASS\n");
+    return 1;
+}
+
 /* ============================================================================
  * Test Runner
  * ============================================================================
@@ -389,6 +927,17 @@ int main(void) {
     if (test_bst_delete_all()) passed++; else failed++;
     if (test_bst_empty_operations()) passed++; else failed++;
     if (test_bst_min_max()) passed++; else failed++;
+    if (test_bst_pooled_recycling()) passed++; else failed++;
+    if (test_bst_degenerate_deep()) passed++; else failed++;
+    if (test_bst_build_sorted()) passed++; else failed++;
+    if (test_bst_bulk_load()) passed++; else failed++;
+    if (test_bst_range_queries()) passed++; else failed++;
+    if (test_bst_neighbours()) passed++; else failed++;
+    if (test_bst_cursor()) passed++; else failed++;
+    if (test_bst_rebalance()) passed++; else failed++;
+    if (test_bst_search_sorted()) passed++; else failed++;
+    if (test_bst_multiset()) passed++; else failed++;
+    if (test_bst_sized_mode()) passed++; else failed++;
     
     printf("\n========================================\n");
     printf("  TEST SUMMARY\n");
@@ -0,0 +1,264 @@
+/**
+ * @file test_compact.c
+ * @brief Unit tests for the compact index-based AVL and Red-Black trees
+ * 
+ * Tests node footprint, packed height/color bits and tree invariants
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "../include/compact.h"
+
+/* ============================================================================
+ * Test Utilities
+ * ============================================================================
+ */
+
+/**
+ * @brief Verify AVL balance and that packed heights are exact
+ * Returns the height in edges (empty = -1), or -2 on violation
+ */
+static int verify_compact_avl(const CompactAVL* t, uint32_t n) {
+    if (n == COMPACT_NIL) return -1;
+    
+    int hl = verify_compact_avl(t, COMPACT_IDX(t->nodes[n].left));
+    int hr = verify_compact_avl(t, t->nodes[n].right);
+    if (hl < -1 || hr < -1) return -2;
+    if (hl - hr > 1 || hr - hl > 1) return -2;
+    
+    int h = 1 + (hl > hr ? hl : hr);
+    if (COMPACT_AVL_HEIGHT(t->nodes[n].left) != h) return -2;
+    return h;
+}
+
+/**
+ * @brief Verify RB coloring; returns black height or -1 on violation
+ */
+static int verify_compact_rbt(const CompactRBT* t, uint32_t n) {
+    if (n == COMPACT_NIL) return 1;
+    
+    int red = COMPACT_RB_COLOR(t->nodes[n].parent) == 0;
+    uint32_t l = t->nodes[n].left;
+    uint32_t r = t->nodes[n].right;
+    
+    if (red) {
+        if (l != COMPACT_NIL && COMPACT_RB_COLOR(t->nodes[l].parent) == 0) return -1;
+        if (r != COMPACT_NIL && COMPACT_RB_COLOR(t->nodes[r].parent) == 0) return -1;
+    }
+    if (l != COMPACT_NIL && COMPACT_RB_IDX(t->nodes[l].parent) != n) return -1;
+    if (r != COMPACT_NIL && COMPACT_RB_IDX(t->nodes[r].parent) != n) return -1;
+    if (l != COMPACT_NIL && t->nodes[l].key >= t->nodes[n].key) return -1;
+    if (r != COMPACT_NIL && t->nodes[r].key <= t->nodes[n].key) return -1;
+    
+    int bl = verify_compact_rbt(t, l);
+    int br = verify_compact_rbt(t, r);
+    if (bl < 0 || bl != br) return -1;
+    return bl + (red ? 0 : 1);
+}
+
+/* ============================================================================
+ * Test Cases
+ * ============================================================================
+ */
+
+/**
+ * @test test_compact_node_sizes
+ * @brief Compact nodes are 12 and 16 bytes
+ */
+int test_compact_node_sizes(void) {
+    printf("Test: Compact node sizes... ");
+    
+    assert(sizeof(CompactAVLNode) == 12);
+    assert(sizeof(CompactRBNode) == 16);
+    
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_compact_avl_sequential
+ * @brief Sorted inserts stay balanced across array growth
+ */
+int test_compact_avl_sequential(void) {
+    printf("Test: Compact AVL sequential insert... ");
+    CompactAVL tree;
+    assert(compact_avl_init(&tree, 0));
+    
+    for (int i = 0; i < 5000; i++) {
+        assert(compact_avl_insert(&tree, i) != COMPACT_NIL);
+    }
+    
+    assert(tree.size == 5000);
+    assert(verify_compact_avl(&tree, tree.root) == compact_avl_height(&tree));
+    assert(compact_avl_height(&tree) <= 17);  /* 1.44 * log2(5000) levels */
+    
+    for (int i = 0; i < 5000; i++) {
+        uint32_t n = compact_avl_search(&tree, i);
+        assert(n != COMPACT_NIL && tree.nodes[n].key == i);
+    }
+    assert(compact_avl_search(&tree, 5000) == COMPACT_NIL);
+    
+    compact_avl_free(&tree);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_compact_avl_delete_reuse
+ * @brief Deleted slots are recycled
+ */
+int test_compact_avl_delete_reuse(void) {
+    printf("Test: Compact AVL delete and slot reuse... ");
+    CompactAVL tree;
+    assert(compact_avl_init(&tree, 64));
+    
+    for (int i = 0; i < 1000; i++) {
+        compact_avl_insert(&tree, (i * 37) % 1000);
+    }
+    for (int i = 0; i < 1000; i += 2) {
+        assert(compact_avl_delete(&tree, i));
+    }
+    assert(!compact_avl_delete(&tree, 0));
+    assert(tree.size == 500);
+    assert(verify_compact_avl(&tree, tree.root) >= 0);
+    
+    uint32_t used = tree.used;
+    for (int i = 0; i < 1000; i += 2) {
+        compact_avl_insert(&tree, i);
+    }
+    assert(tree.used == used);
+    assert(tree.size == 1000);
+    assert(verify_compact_avl(&tree, tree.root) >= 0);
+    
+    compact_avl_free(&tree);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_compact_rbt_properties
+ * @brief RB properties hold with packed color bits
+ */
+int test_compact_rbt_properties(void) {
+    printf("Test: Compact RBT properties... ");
+    CompactRBT tree;
+    assert(compact_rbt_init(&tree, 0));
+    
+    for (int i = 0; i < 4000; i++) {
+        assert(compact_rbt_insert(&tree, (i * 7919) % 4000) != COMPACT_NIL);
+    }
+    
+    assert(tree.size == 4000);
+    assert(COMPACT_RB_COLOR(tree.nodes[tree.root].parent) == 1);
+    assert(verify_compact_rbt(&tree, tree.root) > 0);
+    
+    for (int i = 0; i < 4000; i++) {
+        assert(compact_rbt_search(&tree, i) != COMPACT_NIL);
+    }
+    assert(compact_rbt_search(&tree, -1) == COMPACT_NIL);
+    
+    compact_rbt_free(&tree);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_compact_rbt_delete_reuse
+ * @brief Deletes keep the RB properties and recycle slots
+ */
+int test_compact_rbt_delete_reuse(void) {
+    printf("Test: Compact RBT delete and slot reuse... ");
+    CompactRBT tree;
+    assert(compact_rbt_init(&tree, 64));
+    
+    for (int i = 0; i < 1000; i++) {
+        compact_rbt_insert(&tree, (i * 37) % 1000);
+    }
+    for (int i = 0; i < 1000; i += 2) {
+        assert(compact_rbt_delete(&tree, (i * 13) % 1000));
+        assert(verify_compact_rbt(&tree, tree.root) > 0);
+    }
+    assert(!compact_rbt_delete(&tree, 0));
+    assert(tree.size == 500);
+    for (int i = 0; i < 1000; i++) {
+        assert((compact_rbt_search(&tree, i) != COMPACT_NIL) == (i % 2 == 1));
+    }
+    
+    uint32_t used = tree.used;
+    for (int i = 0; i < 1000; i += 2) {
+        compact_rbt_insert(&tree, i);
+    }
+    assert(tree.used == used);
+    assert(tree.size == 1000);
+    assert(verify_compact_rbt(&tree, tree.root) > 0);
+    
+    for (int i = 0; i < 1000; i++) {
+        assert(compact_rbt_delete(&tree, i));
+    }
+    assert(tree.size == 0 && tree.root == COMPACT_NIL);
+    
+    compact_rbt_free(&tree);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_compact_duplicates
+ * @brief Both trees return the existing node for a present key
+ */
+int test_compact_duplicates(void) {
+    printf("Test: Compact duplicate inserts... ");
+    CompactAVL avl;
+    CompactRBT rbt;
+    assert(compact_avl_init(&avl, 0));
+    assert(compact_rbt_init(&rbt, 0));
+    
+    for (int i = 0; i < 100; i++) {
+        compact_avl_insert(&avl, i);
+        compact_rbt_insert(&rbt, i);
+    }
+    for (int i = 0; i < 100; i++) {
+        assert(compact_avl_insert(&avl, i) == compact_avl_search(&avl, i));
+        assert(compact_rbt_insert(&rbt, i) == compact_rbt_search(&rbt, i));
+    }
+    assert(avl.size == 100 && rbt.size == 100);
+    assert(avl.used == 101 && rbt.used == 101);
+    
+    compact_avl_free(&avl);
+    compact_rbt_free(&rbt);
+    printf("PASS\n");
+    return 1;
+}
+
+/* ============================================================================
+ * Test Runner
+ * ============================================================================
+ */
+
+int main(void) {
+    printf("\n========================================\n");
+    printf("  COMPACT TREE UNIT TESTS\n");
+    printf("========================================\n\n");
+    
+    int passed = 0;
+    int failed = 0;
+    
+    /* Run all tests */
+    if (test_compact_node_sizes()) passed++; else failed++;
+    if (test_compact_avl_sequential()) passed++; else failed++;
+    if (test_compact_avl_delete_reuse()) passed++; else failed++;
+    if (test_compact_rbt_properties()) passed++; else failed++;
+    if (test_compact_rbt_delete_reuse()) passed++; else failed++;
+    if (test_compact_duplicates()) passed++; else failed++;
+    
+    printf("\n========================================\n");
+    printf("  TEST SUMMARY\n");
+    printf("========================================\n");
+    printf("Passed: %d\n", passed);
+    printf("Failed: %d\n", failed);
+    printf("Total:  %d\n", passed + failed);
+    printf("========================================\n\n");
+    
+    return (failed == 0) ? 0 : 1;
+}
@@ -19,7 +19,7 @@
 /**
  * @brief Count nodes in tree
  */
-static int count_nodes(RBTNode* root) {
+static int count_nodes(RBNode* root) {
     if (!root) return 0;
     return 1 + count_nodes(root->left) + count_nodes(root->right);
 }
@@ -27,7 +27,7 @@ static int count_nodes(RBTNode* root) {
 /**
  * @brief Verify red nodes don't have red children
  */
-static int verify_no_red_red(RBTNode* node) {
+static int verify_no_red_red(RBNode* node) {
     if (!node) return 1;
     
     if (node->color == RED) {
@@ -44,7 +44,7 @@ static int verify_no_red_red(RBTNode* node) {
 /**
  * @brief Verify root is black
  */
-static int verify_root_black(RBTNode* root) {
+static int verify_root_black(RBNode* root) {
     if (!root) return 1;
     
     if (root->color != BLACK) {
@@ -58,7 +58,7 @@ static int verify_root_black(RBTNode* root) {
  * @brief Count black nodes on path from node to leaf
  * Returns -1 if black height is inconsistent
  */
-static int verify_black_height(RBTNode* node) {
+static int verify_black_height(RBNode* node) {
     if (!node) return 1;  /* NIL nodes are black */
     
     int left_height = verify_black_height(node->left);
@@ -71,6 +71,90 @@ static int verify_black_height(RBTNode* node) {
     return left_height + increment;
 }
 
+/**
+ * @brief Verify every child's parent pointer points back at its parent
+ */
+static int verify_parent_links(RBNode* node) {
+    if (!node) return 1;
+    
+    if ((node->left && node->left->parent != node) ||
+        (node->right && node->right->parent != node)) {
+        printf("ERROR: Broken parent link at node %d\n", node->key);
+        return 0;
+    }
+    return verify_parent_links(node->left) && verify_parent_links(node->right);
+}
+
+/**
+ * @brief Verify stored subtree sizes (augmented nodes only); returns the
+ * size or -1 on mismatch
+ */
+static int verify_sizes(RBNode* node) {
+    if (!node) return 0;
+    
+    int l = verify_sizes(node->left);
+    int r = verify_sizes(node->right);
+    if (l < 0 || r < 0) return -1;
+    if (node->augmented && RB_AUG(node)->size != l + r + 1) {
+        printf("ERROR: Node %d stores size %d, actual %d\n", node->key, RB_AUG(node)->size, l + r + 1);
+        return -1;
+    }
+    return l + r + 1;
+}
+
+/**
+ * @brief Every augmented node's max_high is the largest interval end below it
+ * Returns the subtree's max_high, or INT_MIN for NIL
+ */
+static int verify_max_high(RBNode* node, int* ok) {
+    if (!node) return INT_MIN;
+    
+    int m = rbt_high(node);
+    int l = verify_max_high(node->left, ok);
+    int r = verify_max_high(node->right, ok);
+    if (l > m) m = l;
+    if (r > m) m = r;
+    if (rbt_high(node) < node->key || (node->augmented && RB_AUG(node)->max_high != m)) {
+        printf("ERROR: Node %d stores max_high %d, actual %d\n", node->key, RB_AUG(node)->max_high, m);
+        *ok = 0;
+    }
+    return m;
+}
+
+static int verify_intervals(RBNode* root) {
+    int ok = 1;
+    verify_max_high(root, &ok);
+    return ok;
+}
+
+/**
+ * @brief All RB invariants at once
+ */
+static int verify_rbt(RBTree* tree) {
+    return verify_root_black(tree->root) &&
+           verify_no_red_red(tree->root) &&
+           verify_black_height(tree->root) > 0 &&
+           (!tree->root || !tree->root->parent) &&
+           verify_parent_links(tree->root) &&
+           verify_sizes(tree->root) >= 0 &&
+           verify_intervals(tree->root);
+}
+
+/**
+ * @brief Range visitor: records keys, stops after `limit` of them
+ */
+typedef struct {
+    int keys[64];
+    int count;
+    int limit;
+} VisitLog;
+
+static int record_key(RBNode* node, void* arg) {
+    VisitLog* log = arg;
+    log->keys[log->count++] = node->key;
+    return log->count < log->limit;
+}
+
 /* ============================================================================
  * Test Cases
  * ============================================================================
@@ -82,16 +166,17 @@ static int verify_black_height(RBTNode* node) {
  */
 int test_rbt_insert_single(void) {
     printf("Test: Insert single node... ");
-    RBTNode* root = NULL;
+    RBTree* tree = rbt_create();
     
-    root = rbt_insert(root, 10);
+    rbt_insert(tree, 10);
+    RBNode* root = tree->root;
     
     assert(root != NULL);
     assert(root->key == 10);
     assert(root->color == BLACK);  /* Root is always black */
-    assert(count_nodes(root) == 1);
+    assert(count_nodes(tree->root) == 1);
     
-    rbt_free(root);
+    rbt_destroy(tree);
     printf("PASS\n");
     return 1;
 }
@@ -102,19 +187,19 @@ int test_rbt_insert_single(void) {
  */
 int test_rbt_insert_sequence(void) {
     printf("Test: Insert sequence {10, 20, 30, 40, 50}... ");
-    RBTNode* root = NULL;
+    RBTree* tree = rbt_create();
     
     int keys[] = {10, 20, 30, 40, 50};
     for (int i = 0; i < 5; i++) {
-        root = rbt_insert(root, keys[i]);
+        rbt_insert(tree, keys[i]);
     }
     
-    assert(count_nodes(root) == 5);
-    assert(verify_root_black(root));
-    assert(verify_no_red_red(root));
-    assert(verify_black_height(root) > 0);
+    assert(count_nodes(tree->root) == 5);
+    assert(verify_root_black(tree->root));
+    assert(verify_no_red_red(tree->root));
+    assert(verify_black_height(tree->root) > 0);
     
-    rbt_free(root);
+    rbt_destroy(tree);
     printf("PASS\n");
     return 1;
 }
@@ -125,18 +210,18 @@ int test_rbt_insert_sequence(void) {
  */
 int test_rbt_search_found(void) {
     printf("Test: Search found... ");
-    RBTNode* root = NULL;
+    RBTree* tree = rbt_create();
     
     int keys[] = {50, 30, 70, 20, 40, 60, 80};
     for (int i = 0; i < 7; i++) {
-        root = rbt_insert(root, keys[i]);
+        rbt_insert(tree, keys[i]);
     }
     
-    assert(rbt_search(root, 50) != NULL);
-    assert(rbt_search(root, 30) != NULL);
-    assert(rbt_search(root, 70) != NULL);
+    assert(rbt_search(tree, 50) != NULL);
+    assert(rbt_search(tree, 30) != NULL);
+    assert(rbt_search(tree, 70) != NULL);
     
-    rbt_free(root);
+    rbt_destroy(tree);
     printf("PASS\n");
     return 1;
 }
@@ -147,17 +232,17 @@ int test_rbt_search_found(void) {
  */
 int test_rbt_search_not_found(void) {
     printf("Test: Search not found... ");
-    RBTNode* root = NULL;
+    RBTree* tree = rbt_create();
     
     int keys[] = {50, 30, 70};
     for (int i = 0; i < 3; i++) {
-        root = rbt_insert(root, keys[i]);
+        rbt_insert(tree, keys[i]);
     }
     
-    assert(rbt_search(root, 100) == NULL);
-    assert(rbt_search(root, 10) == NULL);
+    assert(rbt_search(tree, 100) == NULL);
+    assert(rbt_search(tree, 10) == NULL);
     
-    rbt_free(root);
+    rbt_destroy(tree);
     printf("PASS\n");
     return 1;
 }
@@ -168,20 +253,20 @@ int test_rbt_search_not_found(void) {
  */
 int test_rbt_delete_leaf(void) {
     printf("Test: Delete leaf node... ");
-    RBTNode* root = NULL;
+    RBTree* tree = rbt_create();
     
     int keys[] = {50, 30, 70, 20, 40};
     for (int i = 0; i < 5; i++) {
-        root = rbt_insert(root, keys[i]);
+        rbt_insert(tree, keys[i]);
     }
     
-    root = rbt_delete(root, 20);
+    rbt_delete(tree, 20);
     
-    assert(count_nodes(root) == 4);
-    assert(rbt_search(root, 20) == NULL);
-    assert(verify_root_black(root));
+    assert(count_nodes(tree->root) == 4);
+    assert(rbt_search(tree, 20) == NULL);
+    assert(verify_root_black(tree->root));
     
-    rbt_free(root);
+    rbt_destroy(tree);
     printf("PASS\n");
     return 1;
 }
@@ -192,20 +277,20 @@ int test_rbt_delete_leaf(void) {
  */
 int test_rbt_delete_root(void) {
     printf("Test: Delete root node... ");
-    RBTNode* root = NULL;
+    RBTree* tree = rbt_create();
     
     int keys[] = {50, 30, 70, 20, 40, 60, 80};
     for (int i = 0; i < 7; i++) {
-        root = rbt_insert(root, keys[i]);
+        rbt_insert(tree, keys[i]);
     }
     
-    root = rbt_delete(root, 50);
+    rbt_delete(tree, 50);
     
-    assert(count_nodes(root) == 6);
-    assert(rbt_search(root, 50) == NULL);
-    assert(verify_root_black(root));
+    assert(count_nodes(tree->root) == 6);
+    assert(rbt_search(tree, 50) == NULL);
+    assert(verify_root_black(tree->root));
     
-    rbt_free(root);
+    rbt_destroy(tree);
     printf("PASS\n");
     return 1;
 }
@@ -216,22 +301,23 @@ int test_rbt_delete_root(void) {
  */
 int test_rbt_delete_all(void) {
     printf("Test: Delete all nodes... ");
-    RBTNode* root = NULL;
+    RBTree* tree = rbt_create();
     
     int keys[] = {50, 25, 75, 12, 37, 62, 87};
     for (int i = 0; i < 7; i++) {
-        root = rbt_insert(root, keys[i]);
+        rbt_insert(tree, keys[i]);
     }
     
     for (int i = 0; i < 7; i++) {
-        root = rbt_delete(root, keys[i]);
-        if (root != NULL) {
-            assert(verify_root_black(root));
-            assert(verify_no_red_red(root));
+        rbt_delete(tree, keys[i]);
+        if (tree->root != NULL) {
+            assert(verify_root_black(tree->root));
+            assert(verify_no_red_red(tree->root));
         }
     }
     
-    assert(root == NULL);
+    assert(tree->root == NULL);
+    rbt_destroy(tree);
     printf("PASS\n");
     return 1;
 }
@@ -242,18 +328,18 @@ int test_rbt_delete_all(void) {
  */
 int test_rbt_properties_after_insertions(void) {
     printf("Test: RBT properties after insertions... ");
-    RBTNode* root = NULL;
+    RBTree* tree = rbt_create();
     
     for (int i = 1; i <= 20; i++) {
-        root = rbt_insert(root, i);
+        rbt_insert(tree, i);
     }
     
-    assert(verify_root_black(root));
-    assert(verify_no_red_red(root));
-    assert(verify_black_height(root) > 0);
-    assert(count_nodes(root) == 20);
+    assert(verify_root_black(tree->root));
+    assert(verify_no_red_red(tree->root));
+    assert(verify_black_height(tree->root) > 0);
+    assert(count_nodes(tree->root) == 20);
     
-    rbt_free(root);
+    rbt_destroy(tree);
     printf("PASS\n");
     return 1;
 }
@@ -264,14 +350,943 @@ int test_rbt_properties_after_insertions(void) {
  */
 int test_rbt_empty_operations(void) {
     printf("Test: Operations on empty tree... ");
-    RBTNode* root = NULL;
+    RBTree* tree = rbt_create();
+    
+    assert(rbt_search(tree, 10) == NULL);
+    
+    assert(rbt_delete(tree, 10) == 0);  /* Should not crash */
+    assert(tree->root == NULL);
+    
+    rbt_destroy(tree);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_rbt_delete_churn
+ * @brief Interleaved deletes exercise every fix-up case
+ */
+int test_rbt_delete_churn(void) {
+    printf("Test: Delete churn keeps RBT properties... ");
+    RBTree* tree = rbt_create();
+    const int n = 2000;
+    
+    for (int i = 0; i < n; i++) {
+        rbt_insert(tree, (i * 7919) % n);
+    }
+    for (int i = 0; i < n; i += 2) {
+        assert(rbt_delete(tree, (i * 104729) % n) == 1);
+        if (i % 64 == 0) assert(verify_rbt(tree));
+    }
+    assert(verify_rbt(tree));
+    assert(count_nodes(tree->root) == n / 2);
+    
+    for (int i = 1; i < n; i += 2) {
+        assert(rbt_delete(tree, (i * 104729) % n) == 1);
+    }
+    assert(tree->root == NULL);
+    
+    rbt_destroy(tree);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_rbt_pooled_recycling
+ * @brief Pooled tree reuses deleted nodes
+ */
+int test_rbt_pooled_recycling(void) {
+    printf("Test: Pooled tree recycles nodes... ");
+    RBTree* tree = rbt_create_pooled(32);
+    assert(tree != NULL);
+    
+    for (int i = 0; i < 256; i++) {
+        rbt_insert(tree, i);
+    }
+    size_t slabs = pool_slab_count(tree->pool);
+    
+    for (int i = 0; i < 256; i += 2) {
+        rbt_delete(tree, i);
+    }
+    assert(pool_live(tree->pool) == 128);
+    assert(verify_rbt(tree));
+    
+    for (int i = 0; i < 256; i += 2) {
+        rbt_insert(tree, i);
+    }
+    assert(pool_live(tree->pool) == 256);
+    assert(pool_slab_count(tree->pool) == slabs);
+    assert(verify_rbt(tree));
+    
+    rbt_destroy(tree);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_rbt_build_sorted
+ * @brief Bulk build produces a valid coloring for every size
+ */
+int test_rbt_build_sorted(void) {
+    printf("Test: Build from sorted array... ");
+    
+    for (int n = 0; n <= 200; n++) {
+        int* keys = malloc(sizeof(int) * (n + 1));
+        for (int i = 0; i < n; i++) keys[i] = 2 * i;
+        
+        RBTree* tree = rbt_create();
+        assert(rbt_build_sorted(tree, keys, n) == 1);
+        assert(count_nodes(tree->root) == n);
+        assert(verify_rbt(tree));
+        
+        /* Inserts and deletes keep working on the built tree */
+        rbt_insert(tree, 1);
+        if (n > 0) rbt_delete(tree, keys[n / 2]);
+        assert(verify_rbt(tree));
+        
+        /* Only empty trees can be bulk-built */
+        assert(rbt_build_sorted(tree, keys, n) == 0);
+        
+        rbt_destroy(tree);
+        free(keys);
+    }
+    
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_rbt_bulk_load
+ * @brief Parallel bulk load into heap-backed and pooled trees
+ */
+int test_rbt_bulk_load(void) {
+    printf("Test: Parallel bulk load from unsorted keys... ");
+    const int n = 150000;
+    int* keys = malloc(sizeof(int) * n);
+    for (int i = 0; i < n; i++) {
+        keys[i] = (int)((i * 40503u) % 100003) - 50000;
+    }
+    
+    RBTree* heap = rbt_create();
+    RBTree* pooled = rbt_create_pooled(0);
+    assert(rbt_bulk_load(heap, keys, n, 4) == 1);
+    assert(rbt_bulk_load(pooled, keys, n, 4) == 1);
+    
+    assert(verify_rbt(heap));
+    assert(verify_rbt(pooled));
+    int nodes = count_nodes(heap->root);
+    assert(nodes == count_nodes(pooled->root));
+    assert(pool_live(pooled->pool) == (size_t)nodes);
+    for (int i = 0; i < n; i += 1013) {
+        assert(rbt_search(pooled, keys[i]) != NULL);
+    }
+    
+    /* Only empty trees can be bulk-loaded */
+    assert(rbt_bulk_load(heap, keys, n, 4) == 0);
+    
+    rbt_destroy(heap);
+    rbt_destroy(pooled);
+    free(keys);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_rbt_append_and_hint
+ * @brief Monotonic appends and hinted inserts keep the tree valid; in a
+ * plain tree they never refresh the ancestors
+ */
+int test_rbt_append_and_hint(void) {
+    printf("Test: Append fast path and hinted insert... ");
+    RBTree* tree = rbt_create();
+    
+    /* Increasing timestamps take the append path */
+    for (int i = 0; i < 5000; i++) {
+        RBNode* node = rbt_insert(tree, i * 2);
+        assert(tree->max == node);
+    }
+    assert(verify_rbt(tree));
+    assert(tree->refreshed == 0);
+    
+    /* The same appends into an augmented tree refresh every ancestor */
+    RBTree* aug = rbt_create();
+    assert(rbt_set_augmented(aug, 1));
+    for (int i = 0; i < 5000; i++) rbt_insert(aug, i * 2);
+    assert(aug->refreshed >= 5000LL * 10);
+    rbt_destroy(aug);
+    
+    /* Deleting the maximum hands the cache to its predecessor */
+    rbt_delete(tree, 9998);
+    assert(tree->max->key == 9996);
+    
+    /* Fill the odd gaps using the previous node as the hint, walking in
+     * both directions and from far-away hints */
+    RBNode* hint = rbt_search(tree, 0);
+    for (int i = 1; i < 5000; i += 2) {
+        hint = rbt_insert_hint(tree, hint, i);
+        assert(hint && hint->key == i);
+    }
+    for (int i = 9999; i > 5000; i -= 2) {
+        hint = rbt_insert_hint(tree, hint, i);
+        assert(hint && hint->key == i);
+    }
+    hint = rbt_insert_hint(tree, rbt_find_min(tree->root), 100000);
+    assert(tree->max == hint);
+    hint = rbt_insert_hint(tree, tree->max, -5);
+    assert(hint->key == -5);
+    
+    assert(verify_rbt(tree));
+    assert(tree->refreshed == 0);
+    assert(count_nodes(tree->root) == 5000 - 1 + 2500 + 2500 + 2);
+    for (int i = 0; i < 10000; i++) {
+        if (i != 9998) assert(rbt_search(tree, i) != NULL);
+    }
+    
+    rbt_destroy(tree);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_rbt_finger_search
+ * @brief Finger search agrees with rbt_search for local and far lookups
+ */
+int test_rbt_finger_search(void) {
+    printf("Test: Finger search... ");
+    RBTree* tree = rbt_create();
+    for (int i = 0; i < 3000; i++) {
+        rbt_insert(tree, (i * 7919) % 3000 * 2);  /* even keys */
+    }
+    
+    /* Sliding window of nearby keys, hits and misses */
+    for (int i = 0; i < 6000; i++) {
+        RBNode* found = rbt_finger_search(tree, i);
+        assert(found == rbt_search(tree, i));
+        assert(tree->finger != NULL);
+    }
+    
+    /* Far jumps in both directions */
+    int probes[] = {5998, 0, 3000, -7, 7000, 1234, 1235, 10};
+    for (int i = 0; i < 8; i++) {
+        assert(rbt_finger_search(tree, probes[i]) == rbt_search(tree, probes[i]));
+    }
+    
+    /* Deleting the finger node must not leave it dangling */
+    RBNode* hit = rbt_finger_search(tree, 2000);
+    assert(hit && tree->finger == hit);
+    rbt_delete(tree, 2000);
+    assert(tree->finger != hit);
+    assert(rbt_finger_search(tree, 2000) == NULL);
+    assert(rbt_finger_search(tree, 2002)->key == 2002);
+    
+    rbt_destroy(tree);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_rbt_split_join
+ * @brief Split moves keys >= cut to the other tree; join restores the set
+ */
+int test_rbt_split_join(void) {
+    printf("Test: Split and join... ");
+    const int n = 3000;
+    int cuts[] = {-1, 0, 1, 1500, 2999, 3000, 4000};
+    
+    for (int pooled = 0; pooled < 2; pooled++) {
+        RBTree* tree = pooled ? rbt_create_pooled(64) : rbt_create();
+        for (int i = 0; i < n; i++) {
+            rbt_insert(tree, (i * 7919) % n);
+        }
+        
+        for (int c = 0; c < 7; c++) {
+            RBTree* right = rbt_create();
+            assert(rbt_split(tree, cuts[c], right));
+            assert(verify_rbt(tree) && verify_rbt(right));
+            
+            int expect_left = cuts[c] < 0 ? 0 : (cuts[c] > n ? n : cuts[c]);
+            assert(count_nodes(tree->root) == expect_left);
+            assert(count_nodes(right->root) == n - expect_left);
+            if (right->root) assert(rbt_find_min(right->root)->key >= cuts[c]);
+            if (tree->root) assert(rbt_find_max(tree->root)->key < cuts[c]);
+            
+            /* Order violated: join refuses */
+            if (tree->root && right->root) assert(!rbt_join(right, tree));
+            
+            assert(rbt_join(tree, right));
+            assert(right->root == NULL);
+            assert(verify_rbt(tree));
+            assert(count_nodes(tree->root) == n);
+            rbt_destroy(right);
+        }
+        
+        /* Caches still valid after the joins */
+        assert(rbt_insert(tree, n)->key == n);
+        assert(rbt_find_max(tree->root)->key == n);
+        assert(verify_rbt(tree));
+        
+        /* A split-off half outlives the original when the pool is shared */
+        RBTree* right = rbt_create();
+        assert(rbt_split(tree, 100, right));
+        rbt_destroy(tree);
+        assert(count_nodes(right->root) == n + 1 - 100);
+        assert(rbt_delete(right, 2000) && verify_rbt(right));
+        rbt_destroy(right);
+    }
+    
+    /* Distinct pools (or a pool and the heap) cannot trade nodes: every
+     * call is refused and both trees are left as they were */
+    RBTree* a = rbt_create_pooled(0);
+    RBTree* b = rbt_create_pooled(0);
+    RBTree* heap = rbt_create();
+    rbt_insert(a, 1);
+    assert(!rbt_split(a, 0, b));
+    rbt_insert(b, 2);
+    rbt_insert(heap, 3);
+    assert(!rbt_join(a, b) && !rbt_join(a, heap) && !rbt_join(heap, a));
+    assert(!rbt_union(a, b, 1) && !rbt_intersection(a, b, 1));
+    assert(!rbt_difference(a, b, 1) && !rbt_union(heap, a, 1));
+    assert(count_nodes(a->root) == 1 && rbt_search(a, 1));
+    assert(count_nodes(b->root) == 1 && rbt_search(b, 2));
+    assert(count_nodes(heap->root) == 1 && rbt_search(heap, 3));
+    assert(pool_live(a->pool) == 1 && pool_live(b->pool) == 1);
+    rbt_destroy(a);
+    rbt_destroy(b);
+    rbt_destroy(heap);
+    
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_rbt_set_operations
+ * @brief Union, intersection and difference match a brute-force merge
+ */
+int test_rbt_set_operations(void) {
+    printf("Test: Parallel set operations... ");
+    const int n = 20000;
+    int* expect = malloc(sizeof(int) * 3 * n);
+    
+    for (int op = 0; op < 3; op++) {
+        for (int pooled = 0; pooled < 2; pooled++) {
+            /* a: multiples of 2, b: multiples of 3 (small delta or large) */
+            int nb = pooled ? n : 50;
+            RBTree* a = pooled ? rbt_create_pooled(0) : rbt_create();
+            RBTree* b = rbt_create();
+            if (pooled) b->pool = pool_retain(a->pool);
+            for (int i = 0; i < n; i++) rbt_insert(a, i * 2);
+            for (int i = 0; i < nb; i++) rbt_insert(b, i * 3);
+            
+            int count = 0;
+            for (int k = 0; k < 3 * n; k++) {
+                int in_a = k % 2 == 0 && k < 2 * n;
+                int in_b = k % 3 == 0 && k < 3 * nb;
+                if (op == 0 ? (in_a || in_b) : op == 1 ? (in_a && in_b) : (in_a && !in_b))
+                    expect[count++] = k;
+            }
+            
+            int ok = op == 0 ? rbt_union(a, b, 4)
+                   : op == 1 ? rbt_intersection(a, b, 4)
+                             : rbt_difference(a, b, 4);
+            assert(ok && b->root == NULL);
+            assert(verify_rbt(a));
+            assert(count_nodes(a->root) == count);
+            
+            /* In-order walk through parent links */
+            RBNode* node = rbt_find_min(a->root);
+            for (int i = 0; i < count; i++) {
+                assert(node && node->key == expect[i]);
+                node = rbt_next(node);
+            }
+            assert(node == NULL);
+            if (pooled) assert(pool_live(a->pool) == (size_t)count);
+            
+            rbt_destroy(b);
+            rbt_destroy(a);
+        }
+    }
+    
+    free(expect);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_rbt_range_queries
+ * @brief Range count matches a scan (duplicates included); range delete
+ * keeps the tree valid
+ */
+int test_rbt_range_queries(void) {
+    printf("Test: Range count and range delete... ");
+    RBTree* tree = rbt_create_pooled(0);
+    for (int i = 0; i < 5000; i++) {
+        rbt_insert(tree, (i * 7919) % 5000 * 2);  /* even keys 0..9998 */
+    }
+    for (int i = 0; i < 10; i++) {
+        rbt_insert(tree, 500);                      /* duplicates */
+    }
+    assert(verify_rbt(tree));
+    
+    assert(rbt_range_count(tree, 0, 9998) == 5010);
+    assert(rbt_range_count(tree, 500, 500) == 11);
+    assert(rbt_range_count(tree, 10, 20) == 6);
+    assert(rbt_range_count(tree, 11, 19) == 4);
+    assert(rbt_range_count(tree, INT_MIN, INT_MAX) == 5010);
+    assert(rbt_range_count(tree, 20, 10) == 0);
+    
+    assert(rbt_delete_range(tree, 1001, 2999) == 999);
+    assert(verify_rbt(tree));
+    assert(rbt_search(tree, 1000) && rbt_search(tree, 3000));
+    assert(!rbt_search(tree, 2000));
+    assert(count_nodes(tree->root) == 4011);
+    
+    assert(rbt_delete_range(tree, 500, 500) == 11);
+    assert(rbt_delete_range(tree, 2000, 2998) == 0);
+    assert(rbt_delete_range(tree, INT_MIN, 100) == 51);
+    assert(rbt_delete_range(tree, 9000, INT_MAX) == 500);
+    assert(verify_rbt(tree));
+    assert(count_nodes(tree->root) == 3449);
+    assert(pool_live(tree->pool) == 3449);
+    
+    /* Max cache is still right after the cut */
+    assert(rbt_insert(tree, 8999)->key == 8999);
+    assert(rbt_find_max(tree->root)->key == 8999);
+    assert(verify_rbt(tree));
+    
+    assert(rbt_delete_range(tree, INT_MIN, INT_MAX) == 3450);
+    assert(tree->root == NULL);
+    
+    rbt_destroy(tree);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @brief Overlap visitor: counts intervals, stops after `limit` of them
+ */
+typedef struct {
+    int count;
+    int limit;
+    int last_key;
+    int lo, hi;
+} OverlapLog;
+
+static int record_overlap(RBNode* node, void* arg) {
+    OverlapLog* log = arg;
+    assert(node->key <= log->hi && rbt_high(node) >= log->lo);
+    assert(node->key >= log->last_key);          /* in order of start */
+    log->last_key = node->key;
+    log->count++;
+    return log->count < log->limit;
+}
+
+/**
+ * @test test_rbt_interval_tree
+ * @brief Overlap queries match a brute-force scan through inserts, deletes,
+ * rotations and split/join
+ */
+int test_rbt_interval_tree(void) {
+    printf("Test: Interval tree overlaps... ");
+    const int n = 3000;
+    RBTree* tree = rbt_create_pooled(0);
+    assert(rbt_set_augmented(tree, 1));
+    RBNode** nodes = malloc(sizeof(RBNode*) * n);
+    int* lo = malloc(sizeof(int) * n);
+    int* hi = malloc(sizeof(int) * n);
+    int* live = malloc(sizeof(int) * n);
+    
+    unsigned int seed = 12345;
+    for (int i = 0; i < n; i++) {
+        seed = seed * 1103515245u + 12345u;
+        lo[i] = (int)((seed >> 8) % 100000);
+        hi[i] = lo[i] + (int)((seed >> 4) % (i % 10 == 0 ? 20000 : 300));
+        nodes[i] = rbt_insert_interval(tree, lo[i], hi[i]);
+        live[i] = 1;
+    }
+    assert(rbt_insert_interval(tree, 5, 4) == NULL);
+    assert(verify_rbt(tree));
+    
+    for (int i = 0; i < n; i += 3) {
+        rbt_delete_node(tree, nodes[i]);
+        live[i] = 0;
+    }
+    assert(verify_rbt(tree));
+    
+    for (int q = 0; q < 200; q++) {
+        seed = seed * 1103515245u + 12345u;
+        int a = (int)((seed >> 8) % 110000) - 5000;
+        int b = a + (int)((seed >> 4) % (q % 2 ? 50 : 5000));
+        
+        int expect = 0;
+        for (int i = 0; i < n; i++) {
+            if (live[i] && lo[i] <= b && hi[i] >= a) expect++;
+        }
+        
+        OverlapLog log = { 0, n, INT_MIN, a, b };
+        assert(rbt_visit_overlaps(tree, a, b, record_overlap, &log) == expect);
+        assert(log.count == expect);
+        
+        RBNode* any = rbt_interval_search(tree, a, b);
+        assert(expect ? (any && any->key <= b && rbt_high(any) >= a) : !any);
+    }
+    
+    /* Early stop, empty query */
+    OverlapLog stop = { 0, 3, INT_MIN, 0, 100000 };
+    assert(rbt_visit_overlaps(tree, 0, 100000, record_overlap, &stop) == 3);
+    assert(rbt_visit_overlaps(tree, 10, 5, record_overlap, &stop) == 0);
+    
+    /* Split and join rebuild the augmentation along the cut */
+    RBTree* right = rbt_create();
+    assert(rbt_set_augmented(right, 1));
+    assert(rbt_split(tree, 50000, right));
+    assert(verify_rbt(tree) && verify_rbt(right));
+    assert(rbt_join(tree, right));
+    assert(verify_rbt(tree));
+    
+    rbt_destroy(right);
+    rbt_destroy(tree);
+    free(nodes);
+    free(lo);
+    free(hi);
+    free(live);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_rbt_order_statistics
+ * @brief rank/select agree with the sorted order; sampling covers every key
+ */
+int test_rbt_order_statistics(void) {
+    printf("Test: Rank, select and sampling... ");
+    const int n = 4000;
+    RBTree* tree = rbt_create();
+    assert(rbt_set_augmented(tree, 1));
+    for (int i = 0; i < n; i++) {
+        rbt_insert(tree, (i * 7919) % n * 3);  /* multiples of 3 */
+    }
+    for (int i = 0; i < n; i += 2) {
+        rbt_delete(tree, i * 3);               /* odd multiples left */
+    }
+    assert(verify_rbt(tree));
+    
+    int live = n / 2;
+    for (int k = 0; k < live; k++) {
+        int key = (2 * k + 1) * 3;
+        assert(rbt_select(tree, k)->key == key);
+        assert(rbt_rank(tree, key) == k);
+        assert(rbt_rank(tree, key + 1) == k + 1);
+    }
+    assert(rbt_select(tree, -1) == NULL && rbt_select(tree, live) == NULL);
+    
+    /* Duplicates occupy consecutive ranks */
+    rbt_insert(tree, 9);
+    rbt_insert(tree, 9);
+    assert(rbt_rank(tree, 9) == 1 && rbt_rank(tree, 10) == 4);
+    for (int k = 1; k <= 3; k++) assert(rbt_select(tree, k)->key == 9);
+    assert(rbt_select(tree, 4)->key == 15);
+    rbt_destroy(tree);
+    
+    int hits[8] = {0};
+    RBTree* small = rbt_create();
+    assert(rbt_set_augmented(small, 1));
+    for (int i = 0; i < 8; i++) rbt_insert(small, i);
+    srand(42);
+    for (int i = 0; i < 80000; i++) hits[rbt_sample(small, (unsigned int)rand())->key]++;
+    for (int i = 0; i < 8; i++) assert(hits[i] > 9000 && hits[i] < 11000);
+    rbt_destroy(small);
+    
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_rbt_neighbours
+ * @brief floor/ceil/predecessor/successor match a brute-force scan
+ */
+int test_rbt_neighbours(void) {
+    printf("Test: Floor, ceil, predecessor, successor... ");
+    RBTree* tree = rbt_create();
+    for (int i = 0; i < 100; i++) {
+        rbt_insert(tree, (i * 37) % 100 * 10);
+    }
+    
+    /* Keys are multiples of 10 in [0, 990] */
+    for (int q = -15; q <= 1005; q++) {
+        int fl = q < 0 ? -1 : (q > 990 ? 990 : q / 10 * 10);
+        int ce = q > 990 ? -1 : (q <= 0 ? 0 : (q + 9) / 10 * 10);
+        int pr = q <= 0 ? -1 : (q > 990 ? 990 : (q - 1) / 10 * 10);
+        int su = q >= 990 ? -1 : (q < 0 ? 0 : q / 10 * 10 + 10);
+        
+        RBNode* n = rbt_floor(tree, q);
+        assert(fl < 0 ? n == NULL : n->key == fl);
+        n = rbt_ceil(tree, q);
+        assert(ce < 0 ? n == NULL : n->key == ce);
+        n = rbt_predecessor(tree, q);
+        assert(pr < 0 ? n == NULL : n->key == pr);
+        n = rbt_successor(tree, q);
+        assert(su < 0 ? n == NULL : n->key == su);
+    }
+    
+    /* Stepping through parent links visits every key in order */
+    RBNode* node = rbt_find_min(tree->root);
+    for (int k = 0; k < 100; k++) {
+        assert(node->key == k * 10);
+        if (k > 0) assert(rbt_prev(node)->key == k * 10 - 10);
+        node = rbt_next(node);
+    }
+    assert(node == NULL);
+    assert(rbt_prev(rbt_find_min(tree->root)) == NULL);
+    
+    rbt_destroy(tree);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_rbt_cursor
+ * @brief Cursor walks both ways, seeks to the first of equal keys, survives
+ * unrelated deletes, and bounded visits stop early
+ */
+int test_rbt_cursor(void) {
+    printf("Test: Cursor and range visit... ");
+    RBTree* tree = rbt_create();
+    for (int i = 0; i < 100; i++) rbt_insert(tree, (i * 37) % 100 * 10);
+    
+    RBCursor c;
+    rbt_cursor_init(&c, tree);
+    RBNode* node = rbt_cursor_first(&c);
+    for (int k = 0; k < 100; k++, node = rbt_cursor_next(&c)) assert(node->key == k * 10);
+    assert(node == NULL);
+    node = rbt_cursor_last(&c);
+    for (int k = 99; k >= 0; k--, node = rbt_cursor_prev(&c)) assert(node->key == k * 10);
+    assert(node == NULL);
+    
+    assert(rbt_cursor_seek(&c, 455)->key == 460);
+    assert(rbt_cursor_prev(&c)->key == 450);
+    assert(rbt_cursor_seek(&c, 991) == NULL);
+    
+    /* Deleting other nodes leaves the cursor usable */
+    assert(rbt_cursor_seek(&c, 500)->key == 500);
+    for (int k = 0; k < 100; k += 2) {
+        if (k != 50) rbt_delete(tree, k * 10);
+    }
+    assert(rbt_cursor_next(&c)->key == 510);
+    assert(rbt_cursor_next(&c)->key == 530);
+    
+    /* Duplicates: seek lands on the first, the visit sees all of them */
+    rbt_insert(tree, 530);
+    rbt_insert(tree, 530);
+    int n = 0;
+    for (node = rbt_cursor_seek(&c, 530); node && node->key == 530; node = rbt_cursor_next(&c)) n++;
+    assert(n == 3 && rbt_cursor_prev(&c)->key == 530);
+    
+    VisitLog log = { {0}, 0, 64 };
+    assert(rbt_visit_range(tree, 500, 570, record_key, &log) == 7);
+    assert(log.keys[0] == 500 && log.keys[1] == 510 && log.keys[6] == 570);
+    log.count = 0;
+    log.limit = 2;
+    assert(rbt_visit_range(tree, 0, 990, record_key, &log) == 2);
+    assert(log.keys[1] == 30);
+    
+    rbt_destroy(tree);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_rbt_search_batch
+ * @brief Interleaved batch lookups agree with rbt_search
+ */
+int test_rbt_search_batch(void) {
+    printf("Test: Batched interleaved search... ");
+    const int n = 1000;
+    RBTree* tree = rbt_create_pooled(0);
+    for (int i = 0; i < 20000; i++) {
+        rbt_insert(tree, (i * 7919) % 20000 * 2);  /* even keys */
+    }
+    
+    int* keys = malloc(sizeof(int) * n);
+    RBNode** out = malloc(sizeof(RBNode*) * n);
+    int expect = 0;
+    for (int i = 0; i < n; i++) {
+        keys[i] = (i * 37) % 45000 - 1000;          /* hits, misses, negatives */
+        expect += rbt_search(tree, keys[i]) != NULL;
+    }
+    
+    assert(rbt_search_batch(tree, keys, n, out) == expect);
+    for (int i = 0; i < n; i++) {
+        assert(out[i] == rbt_search(tree, keys[i]));
+    }
+    
+    /* Batches smaller than the window, empty batch, empty tree */
+    rbt_search_batch(tree, keys + 2, 5, out);
+    assert(out[0] == rbt_search(tree, keys[2]) && out[4] == rbt_search(tree, keys[6]));
+    assert(rbt_search_batch(tree, keys, 0, out) == 0);
+    RBTree* empty = rbt_create();
+    assert(rbt_search_batch(empty, keys, n, out) == 0 && out[n - 1] == NULL);
+    
+    rbt_destroy(empty);
+    rbt_destroy(tree);
+    free(keys);
+    free(out);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_rbt_bloom
+ * @brief rbt_search behind the filter: no false negatives through inserts,
+ * deletes, splits, joins and set operations; most misses rejected
+ */
+int test_rbt_bloom(void) {
+    printf("Test: Bloom filter front for misses... ");
+    const int n = 40000;
+    RBTree* tree = rbt_create_pooled(0);
+    assert(rbt_enable_bloom(tree, 12));
+    for (int i = 0; i < n; i++) {
+        rbt_insert(tree, (i * 7919) % n * 2);      /* even keys */
+    }
+    
+    int passed_filter = 0;
+    for (int i = 0; i < n; i++) {
+        assert(rbt_search(tree, i * 2) != NULL);
+        passed_filter += bloom_may_contain(tree->bloom, i * 2 + 1);
+        assert(rbt_search(tree, i * 2 + 1) == NULL);
+    }
+    assert(passed_filter < n / 50);
+    
+    for (int i = 0; i < n; i += 2) {
+        rbt_delete(tree, i * 2);
+    }
+    rbt_delete_range(tree, 0, 999);
+    for (int i = 0; i < n; i++) {
+        int live = i % 2 == 1 && i * 2 > 999;
+        assert((rbt_search(tree, i * 2) != NULL) == live);
+    }
+    
+    /* Split off the top half, join it back, union in fresh keys */
+    RBTree* right = rbt_create();
+    assert(rbt_enable_bloom(right, 0));
+    assert(rbt_split(tree, n, right));
+    assert(rbt_search(tree, n + 2) == NULL && rbt_search(right, n + 2) != NULL);
+    assert(rbt_join(tree, right));
+    assert(rbt_search(tree, n + 2) != NULL && rbt_search(right, n + 2) == NULL);
+    
+    int extra[] = { 1, 3, 5 };
+    assert(rbt_build_sorted(right, extra, 3));
+    assert(rbt_search(right, 3) != NULL);
+    assert(rbt_union(tree, right, 1));
+    assert(rbt_search(tree, 5) != NULL && rbt_search(tree, n + 2) != NULL);
+    assert(verify_rbt(tree));
+    
+    rbt_destroy(right);
+    rbt_destroy(tree);
+    printf("PASS\n");
+    return 1;
+}
+
+/* Every node is reachable through the index under its key, and the index
+ * holds nothing else */
+static int verify_hash_index(RBTree* tree) {
+    size_t distinct = 0;
+    for (RBNode* n = rbt_find_min(tree->root); n; n = rbt_next(n)) {
+        RBNode* hit = (RBNode*)hash_index_get(tree->index, n->key);
+        if (!hit || hit->key != n->key) return 0;
+        RBNode* prev = rbt_prev(n);
+        if (!prev || prev->key != n->key) distinct++;
+    }
+    return hash_index_count(tree->index) == distinct;
+}
+
+/**
+ * @test test_rbt_hash_index
+ * @brief Indexed lookups agree with a plain tree through inserts (with
+ * duplicates), deletes, range deletes, split, join and set operations
+ */
+int test_rbt_hash_index(void) {
+    printf("Test: Hash index lookups... ");
+    const int n = 20000;
+    RBTree* tree = rbt_create_pooled(0);
+    RBTree* plain = rbt_create();
+    for (int i = 0; i < n / 2; i++) {
+        int key = (i * 7919) % (n / 4);        /* every key twice */
+        rbt_insert(tree, key);
+        rbt_insert(plain, key);
+    }
+    assert(rbt_enable_hash_index(tree));
+    for (int i = n / 2; i < n; i++) {
+        int key = (i * 7919) % n;
+        rbt_insert(tree, key);
+        rbt_insert(plain, key);
+    }
+    assert(verify_hash_index(tree));
+    
+    for (int i = 0; i < n; i += 3) {
+        assert(rbt_delete(tree, i) == rbt_delete(plain, i));
+    }
+    assert(rbt_delete_range(tree, 100, 999) == rbt_delete_range(plain, 100, 999));
+    assert(verify_hash_index(tree));
+    for (int key = -5; key < n + 5; key++) {
+        RBNode* hit = rbt_search(tree, key);
+        assert((hit != NULL) == (rbt_search(plain, key) != NULL));
+        assert(!hit || hit->key == key);
+    }
+    
+    /* Split moves index entries to the right tree, join moves them back */
+    RBTree* right = rbt_create();
+    assert(rbt_enable_hash_index(right));
+    assert(rbt_split(tree, n / 2, right));
+    assert(verify_hash_index(tree) && verify_hash_index(right));
+    int moved = rbt_find_min(right->root)->key;
+    assert(rbt_search(tree, moved) == NULL && rbt_search(right, moved) != NULL);
+    assert(rbt_join(tree, right));
+    assert(verify_hash_index(tree) && hash_index_count(right->index) == 0);
+    
+    int extra[] = { n + 1, n + 2, n + 3 };
+    assert(rbt_build_sorted(right, extra, 3));
+    assert(rbt_union(tree, right, 1));
+    assert(verify_hash_index(tree) && rbt_search(tree, n + 2) != NULL);
+    
+    RBNode* found[4];
+    int keys[] = { 1, 999, n + 3, n + 9 };
+    assert(rbt_search_batch(tree, keys, 4, found) == 2);
+    assert(found[0] && found[0]->key == 1 && !found[1] && found[2] && !found[3]);
+    assert(verify_rbt(tree));
+    
+    rbt_disable_hash_index(tree);
+    assert(rbt_search(tree, n + 1) != NULL);
+    
+    rbt_destroy(right);
+    rbt_destroy(plain);
+    rbt_destroy(tree);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_rbt_multiset
+ * @brief Duplicates become counts instead of nodes; deletes decrement,
+ * and the hash index keeps pointing at the surviving node
+ */
+int test_rbt_multiset(void) {
+    printf("Test: Multiset mode counts... ");
+    const int n = 2000;
+    RBTree* tree = rbt_create_pooled(0);
+    assert(rbt_set_multiset(tree, 1));
+    assert(rbt_enable_hash_index(tree));
+    for (int i = 0; i < 4 * n; i++) {
+        rbt_insert(tree, (i * 7919) % n);
+    }
+    assert(rbt_size(tree->root) == n && pool_live(tree->pool) == (size_t)n);
+    assert(rbt_count(tree, 17) == 4);
+    assert(!rbt_set_multiset(tree, 0));            /* not empty */
+    
+    /* The appended maximum takes the fast path: still no new node */
+    RBNode* max = rbt_insert(tree, n - 1);
+    assert(max->count == 5 && pool_live(tree->pool) == (size_t)n);
+    
+    for (int i = 0; i < n; i += 2) {
+        for (int k = 0; k < 3; k++) assert(rbt_delete(tree, i));
+    }
+    assert(rbt_size(tree->root) == n && rbt_count(tree, 0) == 1);
+    for (int i = 0; i < n; i += 4) assert(rbt_delete(tree, i));
+    assert(rbt_size(tree->root) == n - n / 4 && rbt_count(tree, 4) == 0);
+    assert(rbt_count(tree, 2) == 1 && rbt_count(tree, 3) == 4);
+    assert(verify_rbt(tree) && verify_hash_index(tree));
+    
+    /* A count at its limit rejects the next copy */
+    rbt_search(tree, 3)->count = RB_MAX_COUNT - 1;
+    assert(rbt_insert(tree, 3) != NULL);
+    assert(rbt_insert(tree, 3) == NULL && rbt_count(tree, 3) == RB_MAX_COUNT);
+    
+    /* A hint below an equal ancestor still finds it */
+    RBTree* hinted = rbt_create();
+    assert(rbt_set_multiset(hinted, 1));
+    rbt_insert(hinted, 10);
+    RBNode* twenty = rbt_insert(hinted, 20);
+    assert(rbt_insert_hint(hinted, twenty, 10)->count == 2);
+    assert(rbt_size(hinted->root) == 2 && rbt_count(hinted, 10) == 2);
+    assert(rbt_delete(hinted, 10) && rbt_count(hinted, 10) == 1);
+    for (int i = 0; i < 200; i++) {
+        RBNode* hint = rbt_search(hinted, (i * 37) % 100 + 100);
+        if (!hint) hint = rbt_insert(hinted, (i * 37) % 100 + 100);
+        rbt_insert_hint(hinted, hint, (i * 53) % 100 + 100);
+    }
+    assert(rbt_size(hinted->root) == 102 && rbt_count(hinted, 150) == 3);
+    assert(verify_rbt(hinted));
+    rbt_destroy(hinted);
+    
+    /* Plain mode counts duplicate nodes */
+    RBTree* plain = rbt_create();
+    for (int i = 0; i < 3; i++) rbt_insert(plain, 9);
+    assert(rbt_count(plain, 9) == 3 && rbt_size(plain->root) == 3);
+    
+    rbt_destroy(plain);
+    rbt_destroy(tree);
+    printf("PASS\n");
+    return 1;
+}
+
+/**
+ * @test test_rbt_augmented_mode
+ * @brief Plain trees use 32-byte nodes and answer the point queries;
+ * sizes and interval ends need the augmented mode, set while empty
+ */
+int test_rbt_augmented_mode(void) {
+    printf("Test: Augmented mode switch... ");
+    if (sizeof(void*) == 8) {
+        assert(sizeof(RBNode) == 32);
+        assert(sizeof(RBAugNode) == 48);
+    }
+    
+    RBTree* plain = rbt_create_pooled(0);
+    RBTree* aug = rbt_create_pooled(0);
+    assert(rbt_set_augmented(aug, 1));
+    for (int i = 0; i < 1000; i++) {
+        rbt_insert(plain, (i * 7919) % 1000);
+        rbt_insert(aug, (i * 7919) % 1000);
+    }
+    assert(!rbt_set_augmented(plain, 1));          /* not empty */
+    assert(verify_rbt(plain) && verify_rbt(aug));
+    assert(!plain->root->augmented && aug->root->augmented);
+    
+    /* Counting works in both modes; order statistics only when augmented */
+    assert(rbt_size(plain->root) == 1000 && rbt_size(aug->root) == 1000);
+    assert(rbt_range_count(plain, 100, 199) == 100);
+    assert(rbt_range_count(aug, 100, 199) == 100);
+    assert(rbt_rank(plain, 500) == -1 && rbt_rank(aug, 500) == 500);
+    assert(rbt_select(plain, 3) == NULL && rbt_select(aug, 3)->key == 3);
+    assert(rbt_sample(plain, 7) == NULL);
+    
+    /* A plain tree only holds points, but can still be queried for overlaps */
+    assert(rbt_insert_interval(plain, 2000, 2005) == NULL);
+    assert(rbt_insert_interval(plain, 2000, 2000) != NULL);
+    assert(rbt_interval_search(plain, 1500, 2500)->key == 2000);
+    assert(rbt_interval_search(plain, 1500, 1999) == NULL);
+    VisitLog log = { {0}, 0, 64 };
+    assert(rbt_visit_overlaps(plain, 10, 14, record_key, &log) == 5);
     
-    assert(rbt_search(root, 10) == NULL);
+    /* Trees in different modes never trade nodes */
+    RBTree* right = rbt_create();
+    assert(rbt_set_augmented(right, 1));
+    assert(!rbt_split(plain, 500, right) && right->pool == NULL);
+    assert(rbt_set_augmented(right, 0));
+    assert(rbt_split(plain, 500, right));
+    assert(!rbt_set_augmented(right, 1));          /* not empty */
+    assert(verify_rbt(plain) && verify_rbt(right));
+    assert(rbt_join(plain, right));
+    assert(!rbt_set_augmented(right, 1));          /* shares plain's pool */
     
-    root = rbt_delete(root, 10);  /* Should not crash */
-    assert(root == NULL);
+    /* Switching back empty swaps the pool for the smaller nodes */
+    rbt_delete_range(aug, INT_MIN, INT_MAX);
+    assert(rbt_set_augmented(aug, 0));
+    rbt_insert(aug, 1);
+    assert(!aug->root->augmented && pool_live(aug->pool) == 1);
     
-    rbt_free(root);
+    rbt_destroy(right);
+    rbt_destroy(plain);
+    rbt_destroy(aug);
     printf("PASS\n");
     return 1;
 }
@@ -299,6 +1314,24 @@ int main(void) {
     if (test_rbt_delete_all()) passed++; else failed++;
     if (test_rbt_properties_after_insertions()) passed++; else failed++;
     if (test_rbt_empty_operations()) passed++; else failed++;
+    if (test_rbt_delete_churn()) passed++; else failed++;
+    if (test_rbt_pooled_recycling()) passed++; else failed++;
+    if (test_rbt_build_sorted()) passed++; else failed++;
+    if (test_rbt_bulk_load()) passed++; else failed++;
+    if (test_rbt_append_and_hint()) passed++; else failed++;
+    if (test_rbt_finger_search()) passed++; else failed++;
+    if (test_rbt_split_join()) passed++; else failed++;
+    if (test_rbt_set_operations()) passed++; else failed++;
+    if (test_rbt_range_queries()) passed++; else failed++;
+    if (test_rbt_interval_tree()) passed++; else failed++;
+    if (test_rbt_order_statistics()) passed++; else failed++;
+    if (test_rbt_neighbours()) passed++; else failed++;
+    if (test_rbt_cursor()) passed++; else failed++;
+    if (test_rbt_search_batch()) passed++; else failed++;
+    if (test_rbt_bloom()) passed++; else failed++;
+    if (test_rbt_hash_index()) passed++; else failed++;
+    if (test_rbt_multiset()) passed++; else failed++;
+    if (test_rbt_augmented_mode()) passed++; else failed++;
     
     printf("\n========================================\n");
     printf("  TEST SUMMARY\n");